@@ -0,0 +1,283 @@
+/*
+ * ArenaAllocator.cpp
+ */
+
+#include "ArenaAllocator.h"
+
+#include <cstdint>
+#include <cstring>
+#include <new>
+
+#ifndef _WIN32
+#include <sys/mman.h>
+#endif
+
+namespace Benchmark {
+
+namespace {
+const size_t HEADER = 16;                  // keeps the blocks 16 byte aligned
+const size_t HUGE_PAGE = 2 * 1024 * 1024;
+const uint32_t MAGIC = 0xA3E7A5u;
+
+struct BlockHeader
+{
+    uint32_t sizeClass; // usable bytes / 16
+    uint32_t magic;
+};
+
+// the arenas free looks up, slots are reused once an arena is gone. The ranges are
+// kept out of the arenas, so a lookup never touches a mapping being unmapped.
+const size_t MAX_ARENAS = 64;
+std::atomic<Arena*> sArenas[MAX_ARENAS];
+std::atomic<uintptr_t> sBegin[MAX_ARENAS]; // 0 for an empty slot
+std::atomic<uintptr_t> sEnd[MAX_ARENAS];
+std::atomic<size_t> sAlive(0); // lets free skip the lookup while there are no arenas
+std::atomic<size_t> sUsed(0);  // slots past this were never taken
+
+thread_local Arena* tCurrent = nullptr;
+
+struct SpinLock
+{
+    explicit SpinLock(std::atomic_flag& f) : flag(f)
+    {
+        while (flag.test_and_set(std::memory_order_acquire))
+            ;
+    }
+    ~SpinLock() { flag.clear(std::memory_order_release); }
+    std::atomic_flag& flag;
+};
+}
+
+bool Arena::isInterposed()
+{
+#if defined(BENCHMARK_ARENA) && defined(__GLIBC__)
+    return true;
+#else
+    return false;
+#endif
+}
+
+Arena* Arena::create(size_t capacity, bool hugePages)
+{
+#ifndef _WIN32
+    // over-reserve, so the blocks can start on a huge page boundary
+    size_t mapSize = capacity + HUGE_PAGE;
+    void* mapping = mmap(NULL, mapSize, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_NORESERVE, -1, 0);
+    if (mapping == MAP_FAILED)
+        return NULL;
+
+#ifdef MADV_HUGEPAGE
+    if (hugePages)
+        madvise(mapping, mapSize, MADV_HUGEPAGE);
+#else
+    hugePages = false;
+#endif
+
+    Arena* arena = new (mapping) Arena(mapping, mapSize, static_cast<char*>(mapping) + mapSize, hugePages);
+    for (size_t i = 0; i < MAX_ARENAS; ++i)
+    {
+        Arena* expected = NULL;
+        if (sArenas[i].compare_exchange_strong(expected, arena))
+        {
+            arena->mSlot = i;
+            size_t used = sUsed.load(std::memory_order_relaxed);
+            while (used <= i && !sUsed.compare_exchange_weak(used, i + 1))
+                ;
+            sEnd[i].store(reinterpret_cast<uintptr_t>(arena->mEnd), std::memory_order_relaxed);
+            sBegin[i].store(reinterpret_cast<uintptr_t>(arena->mBegin), std::memory_order_release);
+            sAlive.fetch_add(1, std::memory_order_release);
+            return arena;
+        }
+    }
+    munmap(mapping, mapSize); // too many alive
+#endif
+    return NULL;
+}
+
+Arena::Arena(void* mapping, size_t mapSize, char* end, bool hugePages)
+    : mMapping(mapping), mMapSize(mapSize), mSlot(0), mEnd(end), mHugePages(hugePages), mReleased(false), mLive(0)
+{
+    // the blocks follow this object, on the next huge page if asked for
+    uintptr_t first = reinterpret_cast<uintptr_t>(this + 1);
+    size_t align = hugePages ? HUGE_PAGE : 64;
+    mBegin = reinterpret_cast<char*>((first + align - 1) & ~uintptr_t(align - 1));
+    mTop = mBegin;
+    memset(mFree, 0, sizeof(mFree));
+    mLock.clear();
+}
+
+Arena* Arena::find(const void* p)
+{
+    // a block of an arena keeps it alive, and its creation happened before the block was handed out
+    if (sAlive.load(std::memory_order_acquire) == 0)
+        return NULL;
+
+    uintptr_t c = reinterpret_cast<uintptr_t>(p);
+    size_t used = sUsed.load(std::memory_order_acquire);
+    for (size_t i = 0; i < used; ++i)
+    {
+        uintptr_t begin = sBegin[i].load(std::memory_order_acquire);
+        if (begin && c >= begin && c < sEnd[i].load(std::memory_order_relaxed))
+            return sArenas[i].load(std::memory_order_acquire);
+    }
+    return NULL;
+}
+
+void* Arena::allocate(size_t size)
+{
+    if (size > MAX_BLOCK)
+        return NULL;
+
+    size_t sizeClass = size ? (size + 15) / 16 : 1;
+    char* block;
+    {
+        SpinLock lock(mLock);
+        if (void* head = mFree[sizeClass])
+        {
+            mFree[sizeClass] = *static_cast<void**>(head);
+            block = static_cast<char*>(head) - HEADER;
+        }
+        else
+        {
+            size_t bytes = HEADER + sizeClass * 16;
+            if (size_t(mEnd - mTop) < bytes)
+                return NULL;
+            block = mTop;
+            mTop += bytes;
+        }
+        mLive.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    BlockHeader* h = reinterpret_cast<BlockHeader*>(block);
+    h->sizeClass = uint32_t(sizeClass);
+    h->magic = MAGIC;
+    return block + HEADER;
+}
+
+void Arena::deallocate(void* p)
+{
+    BlockHeader* h = reinterpret_cast<BlockHeader*>(static_cast<char*>(p) - HEADER);
+    bool gone;
+    {
+        SpinLock lock(mLock);
+        *static_cast<void**>(p) = mFree[h->sizeClass];
+        mFree[h->sizeClass] = p;
+        gone = mLive.fetch_sub(1, std::memory_order_relaxed) == 1 && mReleased;
+    }
+    if (gone)
+        destroy();
+}
+
+size_t Arena::blockSize(const void* p) const
+{
+    const BlockHeader* h = reinterpret_cast<const BlockHeader*>(static_cast<const char*>(p) - HEADER);
+    return h->sizeClass * 16;
+}
+
+void Arena::release()
+{
+    bool gone;
+    {
+        SpinLock lock(mLock);
+        mReleased = true;
+        gone = mLive.load(std::memory_order_relaxed) == 0;
+    }
+    if (gone)
+        destroy();
+}
+
+void Arena::destroy()
+{
+    // no block is alive, so no free can be looking for this range any more
+    sBegin[mSlot].store(0, std::memory_order_release);
+    sEnd[mSlot].store(0, std::memory_order_relaxed);
+    sArenas[mSlot].store(NULL, std::memory_order_release);
+    sAlive.fetch_sub(1, std::memory_order_release);
+
+#ifndef _WIN32
+    // this object lives in the mapping
+    void* mapping = mMapping;
+    size_t mapSize = mMapSize;
+    this->~Arena();
+    munmap(mapping, mapSize);
+#endif
+}
+
+ArenaScope::ArenaScope(Arena* arena) : mPrevious(tCurrent)
+{
+    tCurrent = arena;
+}
+
+ArenaScope::~ArenaScope()
+{
+    tCurrent = mPrevious;
+}
+
+}
+
+#if defined(BENCHMARK_ARENA) && defined(__GLIBC__)
+// executables take precedence over libc, also for the calls from Ogre and libstdc++
+extern "C" {
+void* __libc_malloc(size_t size);
+void* __libc_calloc(size_t n, size_t size);
+void* __libc_realloc(void* p, size_t size);
+void __libc_free(void* p);
+
+void* malloc(size_t size)
+{
+    if (Benchmark::Arena* a = Benchmark::tCurrent)
+    {
+        if (void* p = a->allocate(size))
+            return p;
+    }
+    return __libc_malloc(size);
+}
+
+void* calloc(size_t n, size_t size)
+{
+    if (Benchmark::Arena* a = Benchmark::tCurrent)
+    {
+        if (size && n > SIZE_MAX / size)
+            return NULL;
+        if (void* p = a->allocate(n * size))
+            return memset(p, 0, n * size); // free lists recycle dirty blocks
+    }
+    return __libc_calloc(n, size);
+}
+
+void free(void* p)
+{
+    if (!p)
+        return;
+    if (Benchmark::Arena* a = Benchmark::Arena::find(p))
+        a->deallocate(p);
+    else
+        __libc_free(p);
+}
+
+void* realloc(void* p, size_t size)
+{
+    Benchmark::Arena* a = p ? Benchmark::Arena::find(p) : NULL;
+    if (!a)
+        return p ? __libc_realloc(p, size) : malloc(size);
+
+    if (size == 0)
+    {
+        a->deallocate(p);
+        return NULL;
+    }
+
+    size_t old = a->blockSize(p);
+    if (size <= old)
+        return p;
+
+    void* q = malloc(size);
+    if (q)
+    {
+        memcpy(q, p, old);
+        a->deallocate(p);
+    }
+    return q;
+}
+}
+#endif
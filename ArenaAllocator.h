@@ -0,0 +1,88 @@
+/*
+ * ArenaAllocator.h
+ *
+ * per-scene memory arenas, optionally on transparent huge pages, that take over
+ * malloc on a thread while an ArenaScope is active
+ */
+
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+
+namespace Benchmark {
+
+/**
+ * A reserved range of address space, filled by bump allocation and recycled through
+ * one free list per 16 byte size class. Blocks up to MAX_BLOCK bytes are served, larger
+ * ones stay on the heap. Every block of a scene created in one go is next to the one
+ * created before it, so walking the scene touches few pages, and with huge pages
+ * few TLB entries.
+ *
+ * Routing malloc into arenas needs the BENCHMARK_ARENA build, which replaces malloc,
+ * calloc, realloc and free. free finds the arena of a block by its address.
+ */
+class Arena
+{
+public:
+    enum { MAX_BLOCK = 4096 };
+
+    /// true if malloc was replaced, otherwise ArenaScope does nothing
+    static bool isInterposed();
+
+    /**
+     * @param capacity bytes of address space to reserve, pages are only backed when touched
+     * @param hugePages ask for transparent huge pages
+     * @return NULL if the address space could not be reserved
+     */
+    static Arena* create(size_t capacity, bool hugePages);
+
+    /// the arena @p p was allocated from, if any
+    static Arena* find(const void* p);
+
+    /// the arena is deleted once the last of its blocks is freed, which may be right away
+    void release();
+
+    /// NULL if @p size is too large or the arena is full
+    void* allocate(size_t size);
+    void deallocate(void* p);
+
+    /// usable bytes of a block of this arena
+    size_t blockSize(const void* p) const;
+
+    size_t getLiveBlocks() const { return mLive.load(std::memory_order_relaxed); }
+    /// bytes of address space handed out so far
+    size_t getUsed() const { return mTop - mBegin; }
+    bool hasHugePages() const { return mHugePages; }
+
+private:
+    Arena(void* mapping, size_t mapSize, char* end, bool hugePages);
+    void destroy();
+
+    void* mMapping; // holds this object, followed by the blocks
+    size_t mMapSize;
+    size_t mSlot;   // in the table of arenas free looks up
+    char* mBegin;
+    char* mTop; // next unused byte
+    char* mEnd;
+    bool mHugePages;
+    bool mReleased;
+    void* mFree[MAX_BLOCK / 16 + 2]; // a free list per size class
+    std::atomic<size_t> mLive;
+    std::atomic_flag mLock;
+};
+
+/// while alive, malloc on this thread allocates from @p arena. NULL keeps the heap.
+class ArenaScope
+{
+public:
+    explicit ArenaScope(Arena* arena);
+    ~ArenaScope();
+
+    ArenaScope(const ArenaScope&) = delete;
+    ArenaScope& operator=(const ArenaScope&) = delete;
+
+private:
+    Arena* mPrevious;
+};
+}
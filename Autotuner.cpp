@@ -0,0 +1,92 @@
+/*
+ * Autotuner.cpp
+ */
+
+#include "Autotuner.h"
+
+#include <algorithm>
+#include <cstdio>
+
+namespace Benchmark {
+
+void Autotuner::addConfig(const std::string& label, const Callback& apply)
+{
+    Config c = {label, apply, 0, mMaxGrid + 1, 0, 0};
+    mConfigs.push_back(c);
+}
+
+void Autotuner::start()
+{
+    mCurrent = 0;
+    queueProbe();
+}
+
+void Autotuner::queueProbe()
+{
+    // 2% of the grid size is about 4% of the node count
+    while(mCurrent < mConfigs.size())
+    {
+        const Config& c = mConfigs[mCurrent];
+        if(c.hi - c.lo > std::max(1, c.lo / 50))
+            break;
+        ++mCurrent;
+    }
+    if(mCurrent >= mConfigs.size())
+        return;
+
+    Config& c = mConfigs[mCurrent];
+    int grid = (c.lo + c.hi) / 2;
+
+    mRunner.addScenario("autotune/" + c.label + "/grid" + std::to_string(grid),
+                        [this, grid]() {
+                            mConfigs[mCurrent].apply();
+                            mRebuild(grid);
+                        },
+                        [this, grid]() {
+                            evaluate(grid);
+                            queueProbe();
+                        });
+}
+
+void Autotuner::evaluate(int grid)
+{
+    Config& c = mConfigs[mCurrent];
+    c.probes++;
+
+    const MetricSamples& metrics = mRunner.getResults().scenarios.back().metrics;
+    MetricSamples::const_iterator it = metrics.find("frame");
+    double time = it != metrics.end() ? percentile(it->second, mPercentile) : 0;
+
+    bool pass = it != metrics.end() && time <= mBudget;
+    printf("autotune %-24s grid %5d (%8d nodes): p%.0f %8.3f ms %s\n", c.label.c_str(), grid, grid * grid,
+           100 * mPercentile, time, pass ? "ok" : "over budget");
+
+    if(pass)
+    {
+        c.lo = grid;
+        c.loTime = time;
+    }
+    else
+    {
+        c.hi = grid;
+    }
+}
+
+void Autotuner::printTable() const
+{
+    printf("\ncapacity for p%.0f <= %.2f ms\n", 100 * mPercentile, mBudget);
+    printf("%-24s %10s %12s %12s %8s\n", "config", "grid", "nodes", "p (ms)", "probes");
+    for(size_t i = 0; i < mConfigs.size(); ++i)
+    {
+        const Config& c = mConfigs[i];
+        if(c.lo == 0)
+        {
+            printf("%-24s %10s %12s %12s %8d\n", c.label.c_str(), "-", "-", "-", c.probes);
+            continue;
+        }
+        printf("%-24s %9d%s %12d %12.3f %8d\n", c.label.c_str(), c.lo, c.lo >= mMaxGrid ? "+" : " ", c.lo * c.lo,
+               c.loTime, c.probes);
+    }
+}
+
+}
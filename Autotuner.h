@@ -0,0 +1,62 @@
+/*
+ * Autotuner.h
+ *
+ * binary searches the largest grid that stays within a frame time budget, once for
+ * every configuration. Every probe is a scenario of the ScenarioRunner, the next
+ * one is queued when the previous one is left.
+ */
+
+#pragma once
+
+#include "ScenarioRunner.h"
+
+namespace Benchmark {
+
+class Autotuner
+{
+public:
+    typedef std::function<void()> Callback;
+    typedef std::function<void(int gridSize)> Rebuild;
+
+    /**
+     * @param budget ms the frame time percentile must stay under
+     * @param rebuild replaces the scene by a grid of the given size
+     */
+    Autotuner(ScenarioRunner& runner, double budget, double percentile, int maxGrid, const Rebuild& rebuild)
+        : mRunner(runner), mBudget(budget), mPercentile(percentile), mMaxGrid(maxGrid), mRebuild(rebuild),
+          mCurrent(0)
+    {
+    }
+
+    /// a configuration to search, e.g. a rendering technique with a number of threads
+    void addConfig(const std::string& label, const Callback& apply);
+
+    /// queue the first probe. Call before ScenarioRunner::start.
+    void start();
+
+    void printTable() const;
+
+private:
+    struct Config
+    {
+        std::string label;
+        Callback apply;
+        int lo;      // largest grid known to pass, 0 if none
+        int hi;      // smallest grid known to fail
+        double loTime; // frame time percentile measured at lo
+        int probes;
+    };
+
+    void queueProbe();
+    void evaluate(int grid);
+
+    ScenarioRunner& mRunner;
+    double mBudget;
+    double mPercentile;
+    int mMaxGrid;
+    Rebuild mRebuild;
+
+    std::vector<Config> mConfigs;
+    size_t mCurrent;
+};
+}
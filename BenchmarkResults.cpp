@@ -0,0 +1,226 @@
+/*
+ * BenchmarkResults.cpp
+ */
+
+#include "BenchmarkResults.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <fstream>
+#include <numeric>
+#include <sstream>
+
+namespace Benchmark {
+
+static const char* RESULTS_HEADER = "# SceneNodeBenchmark results v1";
+
+const ScenarioResult* RunResults::find(const std::string& scenario) const
+{
+    for(size_t i = 0; i < scenarios.size(); ++i)
+    {
+        if(scenarios[i].name == scenario)
+            return &scenarios[i];
+    }
+    return NULL;
+}
+
+double percentile(std::vector<double> samples, double p)
+{
+    if(samples.empty())
+        return 0;
+
+    size_t idx = std::min(samples.size() - 1, size_t(p * (samples.size() - 1) + 0.5));
+    std::nth_element(samples.begin(), samples.begin() + idx, samples.end());
+    return samples[idx];
+}
+
+double mean(const std::vector<double>& samples)
+{
+    if(samples.empty())
+        return 0;
+    return std::accumulate(samples.begin(), samples.end(), 0.0) / samples.size();
+}
+
+bool writeResults(const std::string& path, const RunResults& results)
+{
+    std::ofstream out(path.c_str());
+    if(!out.is_open())
+        return false;
+
+    out << RESULTS_HEADER << "\n";
+    out << "args " << results.args << "\n";
+
+    for(size_t i = 0; i < results.scenarios.size(); ++i)
+    {
+        const ScenarioResult& s = results.scenarios[i];
+        out << "scenario " << s.name << "\n";
+
+        for(MetricSamples::const_iterator it = s.metrics.begin(); it != s.metrics.end(); ++it)
+        {
+            out << "metric " << it->first;
+            for(size_t j = 0; j < it->second.size(); ++j)
+                out << " " << it->second[j];
+            out << "\n";
+        }
+    }
+
+    return out.good();
+}
+
+bool readResults(const std::string& path, RunResults& results)
+{
+    std::ifstream in(path.c_str());
+    std::string line;
+    if(!std::getline(in, line) || line != RESULTS_HEADER)
+        return false;
+
+    results = RunResults();
+    while(std::getline(in, line))
+    {
+        std::istringstream ls(line);
+        std::string key;
+        ls >> key;
+
+        if(key == "args")
+        {
+            std::getline(ls >> std::ws, results.args);
+        }
+        else if(key == "scenario")
+        {
+            results.scenarios.push_back(ScenarioResult());
+            ls >> results.scenarios.back().name;
+        }
+        else if(key == "metric" && !results.scenarios.empty())
+        {
+            std::string name;
+            ls >> name;
+            std::vector<double>& samples = results.scenarios.back().metrics[name];
+
+            double v;
+            while(ls >> v)
+                samples.push_back(v);
+        }
+    }
+
+    return true;
+}
+
+double mannWhitneyU(const std::vector<double>& a, const std::vector<double>& b)
+{
+    const size_t n1 = a.size(), n2 = b.size();
+    if(n1 == 0 || n2 == 0)
+        return 1;
+
+    // rank the pooled samples, ties get the average rank
+    std::vector<std::pair<double, int> > pooled;
+    pooled.reserve(n1 + n2);
+    for(size_t i = 0; i < n1; ++i)
+        pooled.push_back(std::make_pair(a[i], 0));
+    for(size_t i = 0; i < n2; ++i)
+        pooled.push_back(std::make_pair(b[i], 1));
+    std::sort(pooled.begin(), pooled.end());
+
+    double rankSumA = 0;
+    double tieTerm = 0;
+    for(size_t i = 0; i < pooled.size();)
+    {
+        size_t j = i;
+        while(j < pooled.size() && pooled[j].first == pooled[i].first)
+            ++j;
+
+        double rank = 0.5 * (i + 1 + j); // average of the ranks i+1 .. j
+        for(size_t k = i; k < j; ++k)
+        {
+            if(pooled[k].second == 0)
+                rankSumA += rank;
+        }
+
+        double t = double(j - i);
+        tieTerm += t * t * t - t;
+        i = j;
+    }
+
+    double N = double(n1 + n2);
+    double u = rankSumA - n1 * (n1 + 1) / 2.0;
+    double mu = n1 * n2 / 2.0;
+    double sigma = std::sqrt(n1 * n2 / 12.0 * ((N + 1) - tieTerm / (N * (N - 1))));
+    if(sigma == 0)
+        return 1;
+
+    // continuity correction
+    double z = (std::fabs(u - mu) - 0.5) / sigma;
+    return std::erfc(std::max(0.0, z) / std::sqrt(2.0));
+}
+
+std::vector<Comparison> compareResults(const RunResults& baseline, const RunResults& current,
+                                       double thresholdPercent, double alpha)
+{
+    std::vector<Comparison> ret;
+
+    for(size_t i = 0; i < current.scenarios.size(); ++i)
+    {
+        const ScenarioResult& cur = current.scenarios[i];
+        const ScenarioResult* base = baseline.find(cur.name);
+        if(!base)
+            continue;
+
+        for(MetricSamples::const_iterator it = cur.metrics.begin(); it != cur.metrics.end(); ++it)
+        {
+            MetricSamples::const_iterator bit = base->metrics.find(it->first);
+            if(bit == base->metrics.end())
+                continue;
+
+            Comparison c;
+            c.scenario = cur.name;
+            c.metric = it->first;
+            c.baseMedian = percentile(bit->second, 0.5);
+            c.currentMedian = percentile(it->second, 0.5);
+            c.change = c.baseMedian != 0 ? 100 * (c.currentMedian - c.baseMedian) / c.baseMedian : 0;
+            c.pValue = mannWhitneyU(bit->second, it->second);
+            c.verdict = Comparison::UNCHANGED;
+
+            if(c.pValue < alpha && c.change > thresholdPercent)
+                c.verdict = Comparison::REGRESSION;
+            else if(c.pValue < alpha && c.change < -thresholdPercent)
+                c.verdict = Comparison::IMPROVEMENT;
+
+            ret.push_back(c);
+        }
+    }
+
+    return ret;
+}
+
+int printComparison(const std::vector<Comparison>& comparisons)
+{
+    static const char* verdicts[] = {"", "IMPROVEMENT", "REGRESSION"};
+
+    printf("%-20s %-16s %12s %12s %9s %10s\n", "scenario", "metric", "base (med)", "new (med)", "change", "p-value");
+    int regressions = 0;
+    for(size_t i = 0; i < comparisons.size(); ++i)
+    {
+        const Comparison& c = comparisons[i];
+        printf("%-20s %-16s %12.4f %12.4f %+8.2f%% %10.2e  %s\n", c.scenario.c_str(), c.metric.c_str(),
+               c.baseMedian, c.currentMedian, c.change, c.pValue, verdicts[c.verdict]);
+        regressions += c.verdict == Comparison::REGRESSION;
+    }
+    return regressions;
+}
+
+void printSummary(const RunResults& results)
+{
+    printf("%-20s %-16s %10s %10s %10s %10s\n", "scenario", "metric", "mean", "p50", "p95", "p99");
+    for(size_t i = 0; i < results.scenarios.size(); ++i)
+    {
+        const ScenarioResult& s = results.scenarios[i];
+        for(MetricSamples::const_iterator it = s.metrics.begin(); it != s.metrics.end(); ++it)
+        {
+            printf("%-20s %-16s %10.4f %10.4f %10.4f %10.4f\n", s.name.c_str(), it->first.c_str(),
+                   mean(it->second), percentile(it->second, 0.5), percentile(it->second, 0.95),
+                   percentile(it->second, 0.99));
+        }
+    }
+}
+
+}
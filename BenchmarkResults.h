@@ -0,0 +1,73 @@
+/*
+ * BenchmarkResults.h
+ *
+ * per-frame samples of the SceneNodeBenchmark runs, their result files and the
+ * statistical comparison against a stored baseline.
+ */
+
+#pragma once
+
+#include <map>
+#include <string>
+#include <vector>
+
+namespace Benchmark {
+
+/// samples in milliseconds (or counts) keyed by metric name, one entry per measured frame
+typedef std::map<std::string, std::vector<double> > MetricSamples;
+
+struct ScenarioResult
+{
+    std::string name;
+    MetricSamples metrics;
+};
+
+struct RunResults
+{
+    /// the command line options that produced the run, so a comparison can repeat it
+    std::string args;
+    std::vector<ScenarioResult> scenarios;
+
+    const ScenarioResult* find(const std::string& scenario) const;
+};
+
+/// p in [0, 1]
+double percentile(std::vector<double> samples, double p);
+double mean(const std::vector<double>& samples);
+
+bool writeResults(const std::string& path, const RunResults& results);
+bool readResults(const std::string& path, RunResults& results);
+
+/**
+ * two-sided Mann-Whitney U test using the normal approximation with tie correction
+ * @return the p-value of the hypothesis that both sample sets come from the same distribution
+ */
+double mannWhitneyU(const std::vector<double>& a, const std::vector<double>& b);
+
+struct Comparison
+{
+    enum Verdict { UNCHANGED, IMPROVEMENT, REGRESSION };
+
+    std::string scenario;
+    std::string metric;
+    double baseMedian;
+    double currentMedian;
+    double change;  // relative change of the median in percent
+    double pValue;
+    Verdict verdict;
+};
+
+/**
+ * compare every metric present in both runs. A difference is only significant if
+ * the test rejects at @p alpha and the median moved by more than @p thresholdPercent.
+ * Larger values are considered worse for every metric.
+ */
+std::vector<Comparison> compareResults(const RunResults& baseline, const RunResults& current,
+                                       double thresholdPercent, double alpha);
+
+/// print a table of the comparisons and @return the number of regressions
+int printComparison(const std::vector<Comparison>& comparisons);
+
+/// print mean and percentiles of every metric
+void printSummary(const RunResults& results);
+}
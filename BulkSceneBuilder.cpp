@@ -0,0 +1,72 @@
+/*
+ * BulkSceneBuilder.cpp
+ */
+
+#include "BulkSceneBuilder.h"
+
+#include <algorithm>
+
+namespace Benchmark {
+
+void BulkSceneBuilder::createChildSceneNodes(Ogre::SceneNode* parent, const std::vector<NodeTransform>& transforms,
+                                             std::vector<Ogre::SceneNode*>& createdNodes,
+                                             const ObjectFactory& factory)
+{
+    using namespace Ogre;
+
+    createdNodes.reserve(createdNodes.size() + transforms.size());
+
+    // the whole subtree is updated anyway, so skip the per child bookkeeping
+    parent->needUpdate();
+
+    for(size_t i = 0; i < transforms.size(); ++i)
+    {
+        const NodeTransform& t = transforms[i];
+        SceneNode* n = parent->createChildSceneNode(t.position, t.orientation);
+        if(t.scale != Vector3::UNIT_SCALE)
+            n->setScale(t.scale);
+
+        if(factory)
+        {
+            if(MovableObject* mo = factory(i))
+                n->attachObject(mo);
+        }
+
+        createdNodes.push_back(n);
+    }
+}
+
+BulkSceneBuilder::ObjectFactory BulkSceneBuilder::entityFactory(Ogre::SceneManager* scnMgr, const Ogre::String& mesh)
+{
+    Ogre::MeshPtr ptr = Ogre::MeshManager::getSingleton().load(mesh, Ogre::RGN_DEFAULT);
+    return [scnMgr, ptr](size_t) -> Ogre::MovableObject* { return scnMgr->createEntity(ptr); };
+}
+
+BulkSceneBuilder::Locality BulkSceneBuilder::measureLocality(const std::vector<Ogre::SceneNode*>& nodes)
+{
+    Locality ret = {0, 0, 0};
+    if(nodes.size() < 2)
+        return ret;
+
+    std::vector<double> strides;
+    strides.reserve(nodes.size() - 1);
+
+    size_t samePage = 0;
+    uintptr_t lo = uintptr_t(nodes[0]), hi = lo;
+    for(size_t i = 1; i < nodes.size(); ++i)
+    {
+        uintptr_t a = uintptr_t(nodes[i - 1]), b = uintptr_t(nodes[i]);
+        strides.push_back(double(a > b ? a - b : b - a));
+        samePage += (a >> 12) == (b >> 12);
+        lo = std::min(lo, b);
+        hi = std::max(hi, b);
+    }
+
+    std::nth_element(strides.begin(), strides.begin() + strides.size() / 2, strides.end());
+    ret.medianStride = strides[strides.size() / 2];
+    ret.samePage = double(samePage) / (nodes.size() - 1);
+    ret.span = double(hi - lo + sizeof(Ogre::SceneNode)) / nodes.size();
+    return ret;
+}
+
+}
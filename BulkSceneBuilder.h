@@ -0,0 +1,56 @@
+/*
+ * BulkSceneBuilder.h
+ *
+ * creates many child nodes and their attached objects in one call
+ */
+
+#pragma once
+
+#include <Ogre.h>
+
+#include <functional>
+
+namespace Benchmark {
+
+struct NodeTransform
+{
+    Ogre::Vector3 position;
+    Ogre::Quaternion orientation;
+    Ogre::Vector3 scale;
+};
+
+/**
+ * Compared to calling createChildSceneNode, setPosition, scale and attachObject per
+ * node this
+ * - reserves the output storage up front
+ * - passes position and orientation to createChildSceneNode and only sets a scale
+ *   other than 1. Each of them still marks the node as dirty, but while the parent
+ *   is already marked for a full update that is just setting flags.
+ * - marks the parent for a full child update first. Ogre then skips registering
+ *   every single child as "needs update" with the parent.
+ * - resolves the mesh once instead of by name for every Entity
+ */
+class BulkSceneBuilder
+{
+public:
+    /// @return the object to attach to node @p i or NULL
+    typedef std::function<Ogre::MovableObject*(size_t i)> ObjectFactory;
+
+    static void createChildSceneNodes(Ogre::SceneNode* parent, const std::vector<NodeTransform>& transforms,
+                                      std::vector<Ogre::SceneNode*>& createdNodes,
+                                      const ObjectFactory& factory = ObjectFactory());
+
+    /// factory creating Entities of @p mesh
+    static ObjectFactory entityFactory(Ogre::SceneManager* scnMgr, const Ogre::String& mesh);
+
+    struct Locality
+    {
+        double medianStride; // median distance in bytes between consecutive nodes
+        double samePage;     // fraction of consecutive nodes within the same 4 KiB page
+        double span;         // address range covered per node in bytes
+    };
+
+    /// how close the nodes are to each other in memory, in creation order
+    static Locality measureLocality(const std::vector<Ogre::SceneNode*>& nodes);
+};
+}
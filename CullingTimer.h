@@ -0,0 +1,54 @@
+/*
+ * CullingTimer.h
+ *
+ * times the visible object search of a scene manager
+ */
+
+#pragma once
+
+#include <OgreSceneManager.h>
+
+#include <chrono>
+
+namespace Benchmark {
+
+/**
+ * SceneManager::_findVisibleObjects is bracketed by the pre- and postFindVisibleObjects
+ * listener calls, once per viewport and illumination stage. In between the node
+ * hierarchy is culled against the camera and the render queue is filled.
+ */
+class CullingTimer : public Ogre::SceneManager::Listener
+{
+public:
+    typedef std::chrono::steady_clock Clock;
+
+    CullingTimer() : mTime(0), mSearches(0) {}
+
+    void preFindVisibleObjects(Ogre::SceneManager*, Ogre::SceneManager::IlluminationRenderStage, Ogre::Viewport*)
+    {
+        mStart = Clock::now();
+    }
+
+    void postFindVisibleObjects(Ogre::SceneManager*, Ogre::SceneManager::IlluminationRenderStage, Ogre::Viewport*)
+    {
+        mTime += std::chrono::duration<double, std::milli>(Clock::now() - mStart).count();
+        ++mSearches;
+    }
+
+    /// ms spent finding visible objects since the last nextFrame
+    double getTime() const { return mTime; }
+    /// number of searches since the last nextFrame, e.g. one per viewport
+    size_t getSearches() const { return mSearches; }
+
+    void nextFrame()
+    {
+        mTime = 0;
+        mSearches = 0;
+    }
+
+private:
+    Clock::time_point mStart;
+    double mTime;
+    size_t mSearches;
+};
+}
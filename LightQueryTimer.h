@@ -0,0 +1,89 @@
+/*
+ * LightQueryTimer.h
+ *
+ * times the per-object light finding of the scene manager
+ */
+
+#pragma once
+
+#include <OgreMovableObject.h>
+#include <OgreSceneManager.h>
+#include <OgreSceneNode.h>
+
+#include <chrono>
+#include <unordered_map>
+
+namespace Benchmark {
+
+/**
+ * MovableObject::queryLights asks the object listener for the light list first. This
+ * answers with the same list and the same caching as the default path, but measures
+ * SceneNode::findLights, i.e. SceneManager::_populateLightList, on the way. Like the
+ * default path, the list is found again once the lights changed or the object moved.
+ *
+ * With hardware instancing the batches query the lights, not the instanced entities,
+ * so set it as listener of the batches as well.
+ */
+class LightQueryTimer : public Ogre::MovableObject::Listener
+{
+public:
+    typedef std::chrono::steady_clock Clock;
+
+    LightQueryTimer() : mTime(0), mQueries(0) {}
+
+    const Ogre::LightList* objectQueryLights(const Ogre::MovableObject* obj)
+    {
+        Ogre::SceneNode* sn = obj->getParentSceneNode();
+        if(!sn)
+            return NULL; // tag points and the like keep the default path
+
+        Entry& e = mCache[obj];
+        unsigned long counter = sn->getCreator()->_getLightsDirtyCounter();
+        if(e.valid && e.counter == counter)
+            return &e.lights;
+
+        auto start = Clock::now();
+        sn->findLights(e.lights, obj->getBoundingRadius(), obj->getLightMask());
+        mTime += std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+        ++mQueries;
+
+        e.counter = counter;
+        e.valid = true;
+        return &e.lights;
+    }
+
+    void objectMoved(Ogre::MovableObject* obj)
+    {
+        auto it = mCache.find(obj);
+        if(it != mCache.end())
+            it->second.valid = false;
+    }
+
+    /// ms spent finding lights since the last nextFrame
+    double getTime() const { return mTime; }
+    /// light lists computed since the last nextFrame
+    size_t getQueries() const { return mQueries; }
+
+    void nextFrame()
+    {
+        mTime = 0;
+        mQueries = 0;
+    }
+
+    /// forget all objects, e.g. after they were destroyed
+    void clear() { mCache.clear(); }
+
+private:
+    struct Entry
+    {
+        Entry() : counter(0), valid(false) {}
+        Ogre::LightList lights;
+        unsigned long counter;
+        bool valid;
+    };
+
+    std::unordered_map<const Ogre::MovableObject*, Entry> mCache; // stable references
+    double mTime;
+    size_t mQueries;
+};
+}
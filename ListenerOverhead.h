@@ -0,0 +1,120 @@
+/*
+ * ListenerOverhead.h
+ *
+ * synthetic listeners and a probe timing the render queue listener dispatch
+ */
+
+#pragma once
+
+#include <OgreFrameListener.h>
+#include <OgreRenderQueueListener.h>
+#include <OgreSceneManager.h>
+#include "OgreInput.h"
+
+#include <chrono>
+#include <vector>
+
+namespace Benchmark {
+
+/// does nothing but count its callbacks, so they cannot be optimised away
+struct SyntheticListener : public Ogre::FrameListener, public Ogre::RenderQueueListener, public Bites::InputListener
+{
+    SyntheticListener() : calls(0) {}
+
+    bool frameStarted(const Ogre::FrameEvent&) { ++calls; return true; }
+    bool frameRenderingQueued(const Ogre::FrameEvent&) { ++calls; return true; }
+    bool frameEnded(const Ogre::FrameEvent&) { ++calls; return true; }
+
+    void renderQueueStarted(Ogre::uint8, const Ogre::String&, bool&) { ++calls; }
+    void renderQueueEnded(Ogre::uint8, const Ogre::String&, bool&) { ++calls; }
+
+    void frameRendered(const Ogre::FrameEvent&) { ++calls; }
+
+    volatile size_t calls;
+};
+
+/**
+ * The scene manager calls its render queue listeners in the order they were added,
+ * before and after every queue group it renders. The probe adds its own listener
+ * before and after the given ones, so the time between the two is their dispatch.
+ * Two clock reads per group remain, an empty list measures them.
+ */
+class RenderQueueProbe
+{
+public:
+    typedef std::chrono::steady_clock Clock;
+
+    RenderQueueProbe() : mSceneMgr(NULL), mFirst(this, true), mLast(this, false), mTime(0), mGroups(0) {}
+    ~RenderQueueProbe() { detach(); }
+
+    /// add @p listeners to @p scnMgr, bracketed by the probe
+    void attach(Ogre::SceneManager* scnMgr, const std::vector<Ogre::RenderQueueListener*>& listeners)
+    {
+        detach();
+        mSceneMgr = scnMgr;
+        mListeners = listeners;
+
+        mSceneMgr->addRenderQueueListener(&mFirst);
+        for(auto l : mListeners)
+            mSceneMgr->addRenderQueueListener(l);
+        mSceneMgr->addRenderQueueListener(&mLast);
+    }
+
+    /// remove the probe and the listeners it was attached with
+    void detach()
+    {
+        if(!mSceneMgr)
+            return;
+
+        mSceneMgr->removeRenderQueueListener(&mFirst);
+        for(auto l : mListeners)
+            mSceneMgr->removeRenderQueueListener(l);
+        mSceneMgr->removeRenderQueueListener(&mLast);
+        mSceneMgr = NULL;
+        mListeners.clear();
+    }
+
+    /// ms in the listeners since the last nextFrame, started and ended calls
+    double getTime() const { return mTime; }
+    /// queue group invocations since the last nextFrame
+    size_t getGroups() const { return mGroups; }
+
+    void nextFrame()
+    {
+        mTime = 0;
+        mGroups = 0;
+    }
+
+private:
+    struct Edge : public Ogre::RenderQueueListener
+    {
+        Edge(RenderQueueProbe* p, bool f) : probe(p), first(f) {}
+
+        void renderQueueStarted(Ogre::uint8, const Ogre::String&, bool&)
+        {
+            if(first)
+                ++probe->mGroups;
+            probe->edge(first);
+        }
+        void renderQueueEnded(Ogre::uint8, const Ogre::String&, bool&) { probe->edge(first); }
+
+        RenderQueueProbe* probe;
+        bool first;
+    };
+
+    void edge(bool first)
+    {
+        if(first)
+            mStart = Clock::now();
+        else
+            mTime += std::chrono::duration<double, std::milli>(Clock::now() - mStart).count();
+    }
+
+    Ogre::SceneManager* mSceneMgr;
+    std::vector<Ogre::RenderQueueListener*> mListeners;
+    Edge mFirst, mLast;
+    Clock::time_point mStart;
+    double mTime;
+    size_t mGroups;
+};
+}
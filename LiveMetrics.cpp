@@ -0,0 +1,264 @@
+/*
+ * LiveMetrics.cpp
+ */
+
+#include "LiveMetrics.h"
+
+#include <algorithm>
+#include <cstring>
+#include <new>
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace Benchmark {
+
+using namespace LiveMetrics;
+
+SharedMemory::SharedMemory() : mMapping(NULL), mSize(0), mOwner(false)
+{
+#ifdef _WIN32
+    mMapHandle = NULL;
+#endif
+}
+
+SharedMemory::~SharedMemory()
+{
+    close();
+}
+
+#ifdef _WIN32
+// named kernel objects must not contain backslashes, the POSIX style leading slash is dropped
+static std::string mappingName(const std::string& name)
+{
+    return "Local\\" + name.substr(name.find_first_not_of('/'));
+}
+#endif
+
+bool SharedMemory::create(const std::string& name, size_t size)
+{
+    close();
+
+#ifdef _WIN32
+    mMapHandle = CreateFileMappingA(INVALID_HANDLE_VALUE, NULL, PAGE_READWRITE, DWORD(uint64_t(size) >> 32),
+                                    DWORD(size), mappingName(name).c_str());
+    mMapping = mMapHandle ? MapViewOfFile(mMapHandle, FILE_MAP_ALL_ACCESS, 0, 0, size) : NULL;
+    if(mMapping)
+        memset(mMapping, 0, size);
+#else
+    shm_unlink(name.c_str()); // left behind by a crashed run
+    int fd = shm_open(name.c_str(), O_CREAT | O_EXCL | O_RDWR, 0600);
+    if(fd < 0)
+        return false;
+
+    if(ftruncate(fd, off_t(size)) == 0)
+    {
+        mMapping = mmap(NULL, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+        if(mMapping == MAP_FAILED)
+            mMapping = NULL;
+    }
+    ::close(fd);
+
+    if(!mMapping)
+        shm_unlink(name.c_str());
+#endif
+
+    if(!mMapping)
+    {
+        close();
+        return false;
+    }
+
+    mName = name;
+    mSize = size;
+    mOwner = true;
+    return true;
+}
+
+bool SharedMemory::open(const std::string& name)
+{
+    close();
+
+#ifdef _WIN32
+    mMapHandle = OpenFileMappingA(FILE_MAP_READ, FALSE, mappingName(name).c_str());
+    mMapping = mMapHandle ? MapViewOfFile(mMapHandle, FILE_MAP_READ, 0, 0, 0) : NULL;
+    MEMORY_BASIC_INFORMATION info;
+    if(mMapping && VirtualQuery(mMapping, &info, sizeof(info)))
+        mSize = info.RegionSize;
+#else
+    int fd = shm_open(name.c_str(), O_RDONLY, 0);
+    if(fd < 0)
+        return false;
+
+    struct stat st;
+    if(fstat(fd, &st) == 0 && st.st_size > 0)
+    {
+        mSize = size_t(st.st_size);
+        mMapping = mmap(NULL, mSize, PROT_READ, MAP_SHARED, fd, 0);
+        if(mMapping == MAP_FAILED)
+            mMapping = NULL;
+    }
+    ::close(fd);
+#endif
+
+    if(!mMapping)
+    {
+        close();
+        return false;
+    }
+
+    mName = name;
+    return true;
+}
+
+void SharedMemory::close()
+{
+    if(mMapping)
+    {
+#ifdef _WIN32
+        UnmapViewOfFile(mMapping);
+#else
+        munmap(mMapping, mSize);
+        if(mOwner)
+            shm_unlink(mName.c_str());
+#endif
+    }
+#ifdef _WIN32
+    if(mMapHandle)
+        CloseHandle(mMapHandle);
+    mMapHandle = NULL;
+#endif
+
+    mMapping = NULL;
+    mSize = 0;
+    mOwner = false;
+    mName.clear();
+}
+
+bool MetricsPublisher::open(const std::string& name, uint32_t capacity)
+{
+    close();
+
+    if(!mMemory.create(name, sizeof(Header) + capacity * sizeof(Slot)))
+        return false;
+
+    char* data = static_cast<char*>(mMemory.data());
+    mHeader = new (data) Header();
+    mSlots = reinterpret_cast<Slot*>(data + sizeof(Header));
+    for(uint32_t i = 0; i < capacity; ++i)
+        new (mSlots + i) Slot();
+
+    mHeader->capacity = capacity;
+    mHeader->frameSize = sizeof(Frame);
+    mHeader->written.store(0, std::memory_order_relaxed);
+    mHeader->alive.store(1, std::memory_order_relaxed);
+
+    // readers check the magic last
+    std::atomic_thread_fence(std::memory_order_release);
+    memcpy(mHeader->magic, MAGIC, sizeof(MAGIC));
+    return true;
+}
+
+void MetricsPublisher::close()
+{
+    if(mHeader)
+        mHeader->alive.store(0, std::memory_order_release);
+
+    mMemory.close();
+    mHeader = NULL;
+    mSlots = NULL;
+}
+
+void MetricsPublisher::publish(const Frame& frame)
+{
+    if(!mHeader)
+        return;
+
+    uint64_t index = mHeader->written.load(std::memory_order_relaxed);
+    Slot& slot = mSlots[index % mHeader->capacity];
+
+    slot.sequence.store(2 * index + 1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+    slot.frame = frame;
+    slot.sequence.store(2 * index + 2, std::memory_order_release);
+
+    mHeader->written.store(index + 1, std::memory_order_release);
+}
+
+bool MetricsReader::open(const std::string& name)
+{
+    close();
+
+    if(!mMemory.open(name) || mMemory.size() < sizeof(Header))
+    {
+        close();
+        return false;
+    }
+
+    const char* data = static_cast<const char*>(mMemory.data());
+    mHeader = reinterpret_cast<const Header*>(data);
+    if(!std::equal(MAGIC, MAGIC + sizeof(MAGIC), mHeader->magic) || mHeader->frameSize != sizeof(Frame) ||
+       mMemory.size() < sizeof(Header) + mHeader->capacity * sizeof(Slot))
+    {
+        close();
+        return false;
+    }
+    std::atomic_thread_fence(std::memory_order_acquire);
+
+    mSlots = reinterpret_cast<const Slot*>(data + sizeof(Header));
+    uint64_t written = mHeader->written.load(std::memory_order_acquire);
+    mNext = written - std::min<uint64_t>(written, mHeader->capacity);
+    return true;
+}
+
+void MetricsReader::close()
+{
+    mMemory.close();
+    mHeader = NULL;
+    mSlots = NULL;
+    mNext = 0;
+}
+
+size_t MetricsReader::poll(std::vector<Frame>& frames)
+{
+    if(!mHeader)
+        return 0;
+
+    size_t lost = 0;
+    uint64_t written = mHeader->written.load(std::memory_order_acquire);
+    if(written - mNext > mHeader->capacity)
+    {
+        lost += size_t(written - mHeader->capacity - mNext);
+        mNext = written - mHeader->capacity;
+    }
+
+    for(; mNext < written; ++mNext)
+    {
+        const Slot& slot = mSlots[mNext % mHeader->capacity];
+        uint64_t expected = 2 * mNext + 2;
+
+        if(slot.sequence.load(std::memory_order_acquire) != expected)
+        {
+            lost++; // already overwritten
+            continue;
+        }
+        Frame f = slot.frame;
+        std::atomic_thread_fence(std::memory_order_acquire);
+        if(slot.sequence.load(std::memory_order_relaxed) != expected)
+        {
+            lost++;
+            continue;
+        }
+        frames.push_back(f);
+    }
+
+    return lost;
+}
+
+}
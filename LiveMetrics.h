@@ -0,0 +1,135 @@
+/*
+ * LiveMetrics.h
+ *
+ * per-frame stats published into a shared memory ring buffer, so a separate
+ * process can follow a running benchmark without touching its render thread.
+ */
+
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <stdint.h>
+#include <string>
+#include <vector>
+
+namespace Benchmark {
+
+/**
+ * Segment layout: Header, Slot[capacity]
+ *
+ * There is a single writer. Every slot is guarded by its own sequence number,
+ * which is odd while the slot is written and 2 * (frame index + 1) once it holds
+ * that frame. Readers copy a slot and check the sequence did not change, so
+ * neither side ever waits for the other; readers that fall behind lose frames.
+ */
+namespace LiveMetrics
+{
+    static const char MAGIC[8] = {'O', 'G', 'R', 'E', 'L', 'I', 'V', '1'};
+    static const char DEFAULT_NAME[] = "/ogre-benchmark";
+
+    /// times in ms
+    struct Frame
+    {
+        uint64_t number;
+        float frame;
+        float render;
+        float animate;
+        float swap;
+        float latency;
+        float pipelineWait;
+        uint32_t visibleObjects;
+        uint32_t batches;
+        uint32_t triangles;
+    };
+
+    struct Slot
+    {
+        std::atomic<uint64_t> sequence;
+        Frame frame;
+    };
+
+    struct Header
+    {
+        char magic[8];
+        uint32_t capacity;
+        uint32_t frameSize;
+        std::atomic<uint64_t> written; // frames published so far
+        std::atomic<uint32_t> alive;   // cleared when the writer closes
+    };
+}
+
+/// a named memory segment shared between processes
+class SharedMemory
+{
+public:
+    SharedMemory();
+    ~SharedMemory();
+
+    /// create @p name with @p size zeroed bytes, replacing a stale segment of the same name
+    bool create(const std::string& name, size_t size);
+
+    /// map an existing segment read only
+    bool open(const std::string& name);
+
+    /// unmap, and remove the name if this created the segment
+    void close();
+
+    void* data() const { return mMapping; }
+    size_t size() const { return mSize; }
+
+private:
+    std::string mName;
+    void* mMapping;
+    size_t mSize;
+    bool mOwner;
+#ifdef _WIN32
+    void* mMapHandle;
+#endif
+};
+
+class MetricsPublisher
+{
+public:
+    MetricsPublisher() : mHeader(NULL), mSlots(NULL) {}
+    ~MetricsPublisher() { close(); }
+
+    /// @param capacity number of frames a reader may lag behind
+    bool open(const std::string& name, uint32_t capacity = 4096);
+    void close();
+
+    bool isOpen() const { return mHeader != NULL; }
+
+    /// never blocks
+    void publish(const LiveMetrics::Frame& frame);
+
+private:
+    SharedMemory mMemory;
+    LiveMetrics::Header* mHeader;
+    LiveMetrics::Slot* mSlots;
+};
+
+class MetricsReader
+{
+public:
+    MetricsReader() : mHeader(NULL), mSlots(NULL), mNext(0) {}
+
+    /// starts with the frames still in the buffer
+    bool open(const std::string& name);
+    void close();
+
+    /**
+     * append the frames published since the last call
+     * @return number of frames lost because they were overwritten before being read
+     */
+    size_t poll(std::vector<LiveMetrics::Frame>& frames);
+
+    bool isWriterAlive() const { return mHeader && mHeader->alive.load(std::memory_order_acquire); }
+
+private:
+    SharedMemory mMemory;
+    const LiveMetrics::Header* mHeader;
+    const LiveMetrics::Slot* mSlots;
+    uint64_t mNext;
+};
+}
@@ -0,0 +1,128 @@
+/*
+ * MeshLod.cpp
+ */
+
+#include "MeshLod.h"
+
+#include <OgreLodStrategyManager.h>
+
+#if OGRE_VERSION_MAJOR != 2
+#include <OgreComponents.h>
+#endif
+
+#ifdef OGRE_BUILD_COMPONENT_MESHLODGENERATOR
+#include <OgreLodConfig.h>
+#include <OgreMeshLodGenerator.h>
+#endif
+
+#include <chrono>
+#include <memory>
+#include <sstream>
+
+namespace Benchmark {
+
+bool MeshLod::parseLevels(const std::string& list, std::vector<Level>& levels)
+{
+    levels.clear();
+    std::istringstream in(list);
+    std::string item;
+    while(std::getline(in, item, ','))
+    {
+        size_t colon = item.find(':');
+        if(colon == std::string::npos)
+            return false;
+
+        Level l = {Ogre::Real(atof(item.c_str())), Ogre::Real(atof(item.c_str() + colon + 1))};
+        levels.push_back(l);
+    }
+    return !levels.empty();
+}
+
+std::vector<MeshLod::Level> MeshLod::defaultLevels(const Ogre::String& strategy)
+{
+    std::vector<Level> levels;
+    if(strategy == "pixel_count")
+        levels = {{2000, 0.5f}, {500, 0.75f}, {100, 0.9f}};
+    else if(strategy == "screen_ratio_pixel_count")
+        levels = {{0.002f, 0.5f}, {0.0005f, 0.75f}, {0.0001f, 0.9f}};
+    else
+        levels = {{5, 0.5f}, {15, 0.75f}, {40, 0.9f}};
+    return levels;
+}
+
+Ogre::MeshPtr MeshLod::createSphere(Ogre::SceneManager* scnMgr, const Ogre::String& name, int segments, int rings)
+{
+    using namespace Ogre;
+
+    ManualObject* mo = scnMgr->createManualObject();
+    mo->begin("BaseWhite", RenderOperation::OT_TRIANGLE_LIST);
+    for(int r = 0; r <= rings; ++r)
+    {
+        Real phi = Math::PI * r / rings;
+        for(int s = 0; s <= segments; ++s)
+        {
+            Real theta = Math::TWO_PI * s / segments;
+            Vector3 n(std::sin(phi) * std::cos(theta), std::cos(phi), std::sin(phi) * std::sin(theta));
+            mo->position(n);
+            mo->normal(n);
+            mo->textureCoord(Real(s) / segments, Real(r) / rings);
+        }
+    }
+
+    for(int r = 0; r < rings; ++r)
+    {
+        for(int s = 0; s < segments; ++s)
+        {
+            uint32 a = r * (segments + 1) + s, b = a + segments + 1;
+            mo->triangle(a, a + 1, b);
+            mo->triangle(b, a + 1, b + 1);
+        }
+    }
+    mo->end();
+
+    MeshPtr mesh = mo->convertToMesh(name);
+    scnMgr->destroyManualObject(mo);
+    return mesh;
+}
+
+Ogre::MeshPtr MeshLod::createLodCopy(const Ogre::MeshPtr& mesh, const Ogre::String& name,
+                                     const Ogre::String& strategy, const std::vector<Level>& levels)
+{
+#ifdef OGRE_BUILD_COMPONENT_MESHLODGENERATOR
+    using namespace Ogre;
+
+    LodStrategy* lodStrategy = LodStrategyManager::getSingleton().getStrategy(strategy);
+    if(!lodStrategy)
+        return MeshPtr();
+
+    std::unique_ptr<MeshLodGenerator> generator;
+    if(!MeshLodGenerator::getSingletonPtr())
+        generator.reset(new MeshLodGenerator());
+
+    MeshPtr copy = mesh->clone(name);
+    LodConfig config(copy, lodStrategy);
+    for(size_t i = 0; i < levels.size(); ++i)
+        config.createGeneratedLodLevel(levels[i].value, levels[i].reduction);
+    MeshLodGenerator::getSingleton().generateLodLevels(config);
+    return copy;
+#else
+    return Ogre::MeshPtr();
+#endif
+}
+
+double MeshLod::selectLods(const std::vector<Ogre::Entity*>& entities, const Ogre::Camera* cam, size_t& lodSum)
+{
+    auto start = std::chrono::steady_clock::now();
+    const Ogre::Camera* lodCam = cam->getLodCamera();
+    lodSum = 0;
+    for(size_t i = 0; i < entities.size(); ++i)
+    {
+        const Ogre::MeshPtr& mesh = entities[i]->getMesh();
+        const Ogre::LodStrategy* strategy = mesh->getLodStrategy();
+        // the default LOD bias of 1 transforms to 1 for every strategy
+        lodSum += mesh->getLodIndex(strategy->getValue(entities[i], lodCam));
+    }
+    return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+}
+
+}
@@ -0,0 +1,47 @@
+/*
+ * MeshLod.h
+ *
+ * a dense test mesh with generated LOD levels and a replica of the per-object
+ * LOD selection the scene manager does while culling
+ */
+
+#pragma once
+
+#include <Ogre.h>
+
+namespace Benchmark {
+
+class MeshLod
+{
+public:
+    struct Level
+    {
+        Ogre::Real value;     // distance or pixel count, depending on the strategy
+        Ogre::Real reduction; // fraction of the vertices to remove
+    };
+
+    /// "value:reduction,..." e.g. "5:0.5,15:0.75"
+    static bool parseLevels(const std::string& list, std::vector<Level>& levels);
+
+    /// reasonable levels for a strategy of LodStrategyManager, e.g. distance_sphere or pixel_count
+    static std::vector<Level> defaultLevels(const Ogre::String& strategy);
+
+    /// UV sphere of radius 1 with 2 * segments * rings triangles
+    static Ogre::MeshPtr createSphere(Ogre::SceneManager* scnMgr, const Ogre::String& name, int segments,
+                                      int rings);
+
+    /**
+     * copy of @p mesh with @p levels generated by the MeshLodGenerator
+     * @return NULL if Ogre was built without it or the strategy is unknown
+     */
+    static Ogre::MeshPtr createLodCopy(const Ogre::MeshPtr& mesh, const Ogre::String& name,
+                                       const Ogre::String& strategy, const std::vector<Level>& levels);
+
+    /**
+     * what Entity::_notifyCurrentCamera does to pick the mesh LOD
+     * @param lodSum receives the sum of the selected LOD indices
+     * @return ms spent
+     */
+    static double selectLods(const std::vector<Ogre::Entity*>& entities, const Ogre::Camera* cam, size_t& lodSum);
+};
+}
@@ -0,0 +1,148 @@
+/*
+ * MetricsTail.cpp
+ *
+ * follows the live metrics of a running SceneNodeBenchmark and prints rolling
+ * percentiles over the most recent frames.
+ */
+
+#include "LiveMetrics.h"
+#include "BenchmarkResults.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <deque>
+#include <string>
+#include <thread>
+
+namespace {
+
+struct Options
+{
+    std::string name = Benchmark::LiveMetrics::DEFAULT_NAME;
+    size_t window = 600;    // frames
+    int interval = 1000;    // ms between reports
+};
+
+typedef float Benchmark::LiveMetrics::Frame::*Metric;
+
+std::vector<double> samples(const std::deque<Benchmark::LiveMetrics::Frame>& frames, Metric metric)
+{
+    std::vector<double> ret;
+    ret.reserve(frames.size());
+    for(size_t i = 0; i < frames.size(); ++i)
+        ret.push_back(frames[i].*metric);
+    return ret;
+}
+
+void printHeader()
+{
+    printf("%8s %6s %8s | %-23s | %-15s | %-15s | %8s %8s %10s\n", "frame", "lost", "fps", "frame p50/p95/p99 (ms)",
+           "render p50/p99", "animate p50/p99", "swap p50", "visible", "batches");
+}
+
+void printReport(const std::deque<Benchmark::LiveMetrics::Frame>& frames, size_t lost, double fps)
+{
+    using namespace Benchmark;
+    using LiveMetrics::Frame;
+
+    std::vector<double> frame = samples(frames, &Frame::frame);
+    std::vector<double> render = samples(frames, &Frame::render);
+    std::vector<double> animate = samples(frames, &Frame::animate);
+
+    double visible = 0, batches = 0;
+    for(size_t i = 0; i < frames.size(); ++i)
+    {
+        visible += frames[i].visibleObjects;
+        batches += frames[i].batches;
+    }
+
+    printf("%8llu %6zu %8.1f | %7.2f %7.2f %7.2f | %7.2f %7.2f | %7.2f %7.2f | %8.2f %8.0f %10.0f\n",
+           (unsigned long long)frames.back().number, lost, fps, percentile(frame, 0.5), percentile(frame, 0.95),
+           percentile(frame, 0.99), percentile(render, 0.5), percentile(render, 0.99), percentile(animate, 0.5),
+           percentile(animate, 0.99), percentile(samples(frames, &Frame::swap), 0.5), visible / frames.size(),
+           batches / frames.size());
+}
+
+bool parseArgs(int argc, char* argv[], Options& opts)
+{
+    for(int i = 1; i < argc; ++i)
+    {
+        std::string arg = argv[i];
+        auto value = [&arg]() { return arg.substr(arg.find('=') + 1); };
+
+        if(arg.find("--name=") == 0)
+            opts.name = value();
+        else if(arg.find("--window=") == 0)
+            opts.window = std::max(1, atoi(value().c_str()));
+        else if(arg.find("--interval=") == 0)
+            opts.interval = std::max(1, atoi(value().c_str()));
+        else
+            return false;
+    }
+    return true;
+}
+}
+
+int main(int argc, char* argv[])
+{
+    Options opts;
+    if(!parseArgs(argc, argv, opts))
+    {
+        printf("usage: %s [--name=%s] [--window=frames] [--interval=ms]\n", argv[0],
+               Benchmark::LiveMetrics::DEFAULT_NAME);
+        return 1;
+    }
+
+    Benchmark::MetricsReader reader;
+    if(!reader.open(opts.name))
+    {
+        printf("waiting for %s\n", opts.name.c_str());
+        while(!reader.open(opts.name))
+            std::this_thread::sleep_for(std::chrono::milliseconds(opts.interval));
+    }
+
+    printHeader();
+
+    std::deque<Benchmark::LiveMetrics::Frame> window;
+    std::vector<Benchmark::LiveMetrics::Frame> received;
+    size_t lost = 0;
+    size_t reports = 0;
+    uint64_t lastNumber = 0;
+    auto lastReport = std::chrono::steady_clock::now();
+
+    while(true)
+    {
+        // checked before polling, so the frames published before closing are still reported
+        bool alive = reader.isWriterAlive();
+
+        received.clear();
+        lost += reader.poll(received);
+        window.insert(window.end(), received.begin(), received.end());
+        while(window.size() > opts.window)
+            window.pop_front();
+
+        auto now = std::chrono::steady_clock::now();
+        double elapsed = std::chrono::duration<double>(now - lastReport).count();
+        if(elapsed * 1000 >= opts.interval || !alive)
+        {
+            if(!window.empty() && window.back().number != lastNumber)
+            {
+                if(++reports % 20 == 0)
+                    printHeader();
+                printReport(window, lost, (window.back().number - lastNumber) / elapsed);
+                lastNumber = window.back().number;
+            }
+            lastReport = now;
+        }
+
+        if(!alive)
+        {
+            printf("benchmark finished\n");
+            return 0;
+        }
+
+        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    }
+}
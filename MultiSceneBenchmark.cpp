@@ -0,0 +1,128 @@
+/*
+ * MultiSceneBenchmark.cpp
+ */
+
+#include "MultiSceneBenchmark.h"
+#include "BulkSceneBuilder.h"
+#include "OgreTraceRecorder.h"
+
+#include <algorithm>
+#include <chrono>
+
+namespace Benchmark {
+
+void MultiSceneBenchmark::createScenes(size_t count, int gridSize)
+{
+    using namespace Ogre;
+
+    destroyScenes();
+
+    std::vector<NodeTransform> transforms(gridSize * gridSize);
+    for(int i = 0; i < gridSize; ++i)
+    {
+        for(int j = 0; j < gridSize; ++j)
+        {
+            NodeTransform& t = transforms[i * gridSize + j];
+            t.position = Vector3(0.5f * (i - gridSize / 2), 0.0f, 0.5f * (j - gridSize / 2));
+            t.orientation = Quaternion::IDENTITY;
+            t.scale = Vector3(0.2f);
+        }
+    }
+
+    for(size_t k = 0; k < count; ++k)
+    {
+        Scene scene;
+#if OGRE_VERSION_MAJOR == 2
+        scene.scnMgr = mRoot->createSceneManager(ST_GENERIC, 1, INSTANCING_CULLING_SINGLETHREAD);
+#else
+        scene.scnMgr = mRoot->createSceneManager(ST_GENERIC);
+#endif
+
+        BulkSceneBuilder::createChildSceneNodes(scene.scnMgr->getRootSceneNode(), transforms, scene.nodes,
+                                                BulkSceneBuilder::entityFactory(scene.scnMgr, "Cube_d.mesh"));
+
+        // the middle one of the camera presets of the main scene
+        scene.camera = scene.scnMgr->createCamera("MultiSceneCam");
+        scene.camera->setNearClipDistance(0.1f);
+        scene.camera->setFarClipDistance(300.0f);
+#if OGRE_VERSION_MAJOR == 2
+        scene.scnMgr->getRootSceneNode()->detachObject(scene.camera);
+#endif
+        SceneNode* camNode = scene.scnMgr->getRootSceneNode()->createChildSceneNode();
+        camNode->attachObject(scene.camera);
+        camNode->setFixedYawAxis(true);
+        camNode->setPosition(Vector3(0, 10, -10));
+        camNode->lookAt(Vector3(0, 0, 0), SceneNode::TS_PARENT);
+
+        mScenes.push_back(scene);
+    }
+
+    mNodesPerScene = transforms.size();
+
+    // a serial frame first, so materials resolve their techniques (and possibly run the
+    // RTSS) outside of the concurrent part
+    for(size_t k = 0; k < mScenes.size(); ++k)
+        updateScene(mScenes[k], false);
+}
+
+void MultiSceneBenchmark::destroyScenes()
+{
+    for(size_t k = 0; k < mScenes.size(); ++k)
+        mRoot->destroySceneManager(mScenes[k].scnMgr);
+    mScenes.clear();
+    mNodesPerScene = 0;
+}
+
+void MultiSceneBenchmark::updateScene(Scene& scene, bool rotate)
+{
+    if(rotate)
+    {
+        for(size_t i = 0; i < scene.nodes.size(); ++i)
+            scene.nodes[i]->roll(Ogre::Radian(0.08));
+    }
+
+#if OGRE_VERSION_MAJOR == 2
+    // culling is driven by the compositor in 2.x
+    scene.scnMgr->updateSceneGraph();
+#else
+    // what SceneManager::_renderScene does before submitting anything to the render system.
+    // _updateSceneGraph is avoided as it processes the global Node update queue.
+    scene.scnMgr->getRootSceneNode()->_update(true, false);
+
+    Ogre::VisibleObjectsBoundsInfo bounds;
+    scene.scnMgr->getRenderQueue()->clear();
+    scene.scnMgr->_findVisibleObjects(scene.camera, &bounds, false);
+#endif
+}
+
+std::vector<double> MultiSceneBenchmark::run(size_t active, size_t frames, bool rotate)
+{
+    typedef std::chrono::steady_clock Clock;
+
+    active = std::min(active, mScenes.size());
+
+    std::vector<double> times;
+    times.reserve(frames);
+    for(size_t f = 0; f < frames; ++f)
+    {
+        auto start = Clock::now();
+
+#if OGRE_VERSION_MAJOR != 2
+        // shared by all scene managers, so processed once on the calling thread
+        Ogre::Node::processQueuedUpdates();
+#endif
+
+        mJobs->parallel_for(0, active, 1, [this, rotate](size_t begin, size_t end) {
+            for(size_t k = begin; k < end; ++k)
+            {
+                Bites::TraceScope trace("updateScene", "multiscene");
+                updateScene(mScenes[k], rotate);
+            }
+        });
+
+        times.push_back(std::chrono::duration<double, std::milli>(Clock::now() - start).count());
+    }
+    return times;
+}
+
+}
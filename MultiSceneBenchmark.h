@@ -0,0 +1,51 @@
+/*
+ * MultiSceneBenchmark.h
+ *
+ * K independent scene managers, each with its own node grid and camera, updated
+ * and culled concurrently on the job system.
+ */
+
+#pragma once
+
+#include <Ogre.h>
+#include "OgreJobSystem.h"
+
+namespace Benchmark {
+
+class MultiSceneBenchmark
+{
+public:
+    MultiSceneBenchmark(Ogre::Root* root, Bites::JobSystem* jobs) : mRoot(root), mJobs(jobs), mNodesPerScene(0) {}
+    ~MultiSceneBenchmark() { destroyScenes(); }
+
+    /// create @p count scene managers with a @p gridSize x @p gridSize grid of cubes each
+    void createScenes(size_t count, int gridSize);
+    void destroyScenes();
+
+    /**
+     * update the scene graph and find the visible objects of the first @p active scenes,
+     * one job per scene
+     * @param rotate roll every node before updating, like the main scene does
+     * @return ms per frame
+     */
+    std::vector<double> run(size_t active, size_t frames, bool rotate);
+
+    size_t getNumScenes() const { return mScenes.size(); }
+    size_t getNodesPerScene() const { return mNodesPerScene; }
+
+private:
+    struct Scene
+    {
+        Ogre::SceneManager* scnMgr;
+        Ogre::Camera* camera;
+        std::vector<Ogre::SceneNode*> nodes;
+    };
+
+    void updateScene(Scene& scene, bool rotate);
+
+    Ogre::Root* mRoot;
+    Bites::JobSystem* mJobs;
+    std::vector<Scene> mScenes;
+    size_t mNodesPerScene;
+};
+}
@@ -30,6 +30,36 @@ namespace Bites {
 
 static const char* SHADER_CACHE_FILENAME = "cache.bin";
 
+namespace {
+/// forwards the frame callbacks to the context, recording each of them
+class TracingFrameListener : public Ogre::FrameListener
+{
+public:
+    explicit TracingFrameListener(Ogre::FrameListener* target) : mTarget(target) {}
+
+    bool frameStarted(const Ogre::FrameEvent& evt)
+    {
+        TraceScope trace("frameStarted", "frame");
+        return mTarget->frameStarted(evt);
+    }
+
+    bool frameRenderingQueued(const Ogre::FrameEvent& evt)
+    {
+        TraceScope trace("frameRenderingQueued", "frame");
+        return mTarget->frameRenderingQueued(evt);
+    }
+
+    bool frameEnded(const Ogre::FrameEvent& evt)
+    {
+        TraceScope trace("frameEnded", "frame");
+        return mTarget->frameEnded(evt);
+    }
+
+private:
+    Ogre::FrameListener* mTarget;
+};
+}
+
 ApplicationContext::ApplicationContext(const Ogre::String& appName, bool grabInput)
 #if (OGRE_THREAD_PROVIDER == 3) && (OGRE_NO_TBB_SCHEDULER == 1)
     : mTaskScheduler(tbb::task_scheduler_init::deferred)
@@ -43,6 +73,20 @@ ApplicationContext::ApplicationContext(const Ogre::String& appName, bool grabInp
     mOverlaySystem = NULL;
     mSDLWindow = NULL;
     mFirstRun = true;
+    mJobSystem = NULL;
+    mNumWorkerThreads = -1;
+    mPreloadInBackground = true;
+    mResourceLoader = NULL;
+    mAsyncLogging = false;
+    mAsyncLogCapacity = 4096;
+    mLogManager = NULL;
+    mAsyncLog = NULL;
+    mLogSuppressed = false;
+    mRecording = NULL;
+    mReplay = NULL;
+    mReplayFrame = 0;
+    mTrace = NULL;
+    mTraceFrameListener = NULL;
 
 #if OGRE_PLATFORM == OGRE_PLATFORM_ANDROID
     mAAssetMgr = NULL;
@@ -58,6 +102,12 @@ ApplicationContext::ApplicationContext(const Ogre::String& appName, bool grabInp
 
 ApplicationContext::~ApplicationContext()
 {
+    delete mRecording;
+    delete mReplay;
+    delete mResourceLoader;
+    delete mAsyncLog;
+    delete mTraceFrameListener;
+    delete mTrace;
     delete mFSLayer;
 }
 
@@ -100,6 +150,26 @@ void ApplicationContext::closeApp()
     mRoot->saveConfig();
 #endif
 
+    // the preparing jobs must be done before the resources go away
+    delete mResourceLoader;
+    mResourceLoader = NULL;
+
+    if (mRecording)
+    {
+        if (!mRecording->save(mRecordingPath))
+            Ogre::LogManager::getSingleton().logMessage("could not write input recording to "+mRecordingPath, Ogre::LML_CRITICAL);
+        delete mRecording;
+        mRecording = NULL;
+    }
+
+    if (mTrace)
+    {
+        mTrace->deactivate();
+        mTrace->detachProfiler();
+        if (!mTrace->write(mTracePath))
+            Ogre::LogManager::getSingleton().logMessage("could not write trace to "+mTracePath, Ogre::LML_CRITICAL);
+    }
+
     shutdown();
     if (mRoot)
     {
@@ -107,6 +177,15 @@ void ApplicationContext::closeApp()
         mRoot = NULL;
     }
 
+    // after Root, which logs its shutdown
+    if (mLogManager)
+    {
+        OGRE_DELETE mLogManager;
+        mLogManager = NULL;
+    }
+    delete mAsyncLog;
+    mAsyncLog = NULL;
+
 #ifdef OGRE_STATIC_LIB
     mStaticPluginLoader.unload();
 #endif
@@ -115,6 +194,15 @@ void ApplicationContext::closeApp()
     if (mTaskScheduler.is_active())
         mTaskScheduler.terminate();
 #endif
+
+    delete mJobSystem;
+    mJobSystem = NULL;
+
+    // only now no thread can report to the trace anymore
+    delete mTraceFrameListener;
+    mTraceFrameListener = NULL;
+    delete mTrace;
+    mTrace = NULL;
 }
 
 bool ApplicationContext::initialiseRTShaderSystem()
@@ -186,24 +274,58 @@ void ApplicationContext::setup()
 {
     mWindow = createWindow();
     setupInput(mGrabInput);
-    locateResources();
+    {
+        TraceScope trace("locateResources", "resources");
+        locateResources();
+    }
 #ifdef OGRE_BUILD_COMPONENT_RTSHADERSYSTEM
     initialiseRTShaderSystem();
 #endif
-    loadResources();
+    {
+        TraceScope trace("loadResources", "resources");
+        loadResources();
+    }
 
     // adds context as listener to process context-level (above the sample level) events
-    mRoot->addFrameListener(this);
+    mRoot->addFrameListener(mTrace ? mTraceFrameListener : this);
 #if OGRE_PLATFORM != OGRE_PLATFORM_ANDROID
     WindowEventUtilities::addWindowEventListener(mWindow, this);
 #endif
 }
 
+void ApplicationContext::setLogSuppressed(bool suppress)
+{
+    if (suppress == mLogSuppressed)
+        return;
+    mLogSuppressed = suppress;
+
+    Ogre::Log* log = Ogre::LogManager::getSingleton().getDefaultLog();
+#if OGRE_VERSION >= (13 << 16)
+    if (suppress)
+        mLogLevel = log->getMinLogLevel();
+    log->setMinLogLevel(suppress ? Ogre::LML_CRITICAL : mLogLevel);
+#else
+    if (suppress)
+        mLogLevel = log->getLogDetail();
+    log->setLogDetail(suppress ? Ogre::LL_LOW : mLogLevel);
+#endif
+}
+
 void ApplicationContext::createRoot()
 {
 #if (OGRE_THREAD_PROVIDER == 3) && (OGRE_NO_TBB_SCHEDULER == 1)
     mTaskScheduler.initialize(OGRE_THREAD_HARDWARE_CONCURRENCY);
 #endif
+    mJobSystem = new JobSystem(mNumWorkerThreads, mWorkerCpus);
+
+    if (mAsyncLogging)
+    {
+        // Root only creates a log manager if there is none yet
+        mLogManager = OGRE_NEW Ogre::LogManager();
+        Ogre::Log* log = mLogManager->createLog("ogre.log", true, true, true);
+        mAsyncLog = new AsyncLog("ogre.log", mAsyncLogCapacity);
+        log->addListener(mAsyncLog);
+    }
 
 #if OGRE_PLATFORM == OGRE_PLATFORM_ANDROID || OGRE_PLATFORM == OGRE_PLATFORM_EMSCRIPTEN
     mRoot = OGRE_NEW Ogre::Root("");
@@ -215,6 +337,9 @@ void ApplicationContext::createRoot()
     mRoot = OGRE_NEW Ogre::Root(pluginsPath, "ogre.cfg", "ogre.log");
 #endif
 
+    if (mTrace)
+        mTrace->attachProfiler();
+
 #ifdef OGRE_STATIC_LIB
     mStaticPluginLoader.load();
 #endif
@@ -244,6 +369,84 @@ void ApplicationContext::enableShaderCache() const
     }
 }
 
+void ApplicationContext::startRendering(Ogre::Real fixedTimeStep)
+{
+    finishResourceLoading();
+
+    mRoot->getRenderSystem()->_initRenderTargets();
+    mRoot->clearEventTimes();
+    mRoot->queueEndRendering(false);
+
+    while (!mRoot->endRenderingQueued())
+    {
+        TraceScope trace("frame", "frame");
+        bool ret;
+        if (mReplay && mReplayFrame >= mReplay->getNumFrames())
+            break;
+        else if (fixedTimeStep > 0)
+            ret = mRoot->renderOneFrame(fixedTimeStep);
+        else if (mReplay)
+            ret = mRoot->renderOneFrame(mReplay->getFrame(mReplayFrame).timeStep);
+        else
+            ret = mRoot->renderOneFrame();
+
+        if (!ret)
+            break;
+    }
+}
+
+void ApplicationContext::startTracing(const Ogre::String& path)
+{
+    delete mTraceFrameListener;
+    delete mTrace;
+
+    TraceRecorder::setThreadName("main");
+    mTrace = new TraceRecorder();
+    mTracePath = path;
+    mTraceFrameListener = new TracingFrameListener(this);
+    mTrace->activate();
+}
+
+void ApplicationContext::startInputRecording(const Ogre::String& path)
+{
+    delete mRecording;
+    mRecording = new InputRecording();
+    mRecordingPath = path;
+}
+
+bool ApplicationContext::startInputReplay(const Ogre::String& path)
+{
+    delete mReplay;
+    mReplay = new InputRecording();
+    mReplayFrame = 0;
+
+    if (!mReplay->load(path))
+    {
+        delete mReplay;
+        mReplay = NULL;
+        return false;
+    }
+    return true;
+}
+
+bool ApplicationContext::frameStarted(const Ogre::FrameEvent& evt)
+{
+    if (mRecording)
+        mRecording->beginFrame(evt.timeSinceLastFrame);
+
+    // keeps the window alive. Live input is dropped while replaying.
+    pollEvents();
+
+    if (mReplay && mReplayFrame < mReplay->getNumFrames())
+    {
+        const InputRecording::Frame& f = mReplay->getFrame(mReplayFrame++);
+        for (size_t i = 0; i < f.events.size(); ++i)
+            _fireInputEvent(f.events[i]);
+    }
+
+    return true;
+}
+
 bool ApplicationContext::frameRenderingQueued(const Ogre::FrameEvent& evt)
 {
     for(std::set<InputListener*>::iterator it = mInputListeners.begin();
@@ -391,6 +594,9 @@ void ApplicationContext::_fireInputEventAndroid(AInputEvent* event, int wheel) {
 
 void ApplicationContext::_fireInputEvent(const Event& event) const
 {
+    if (mRecording)
+        mRecording->addEvent(event);
+
     for(std::set<InputListener*>::iterator it = mInputListeners.begin();
             it != mInputListeners.end(); ++it) {
         InputListener& l = **it;
@@ -480,6 +686,27 @@ void ApplicationContext::locateResources()
 void ApplicationContext::loadResources()
 {
     Ogre::ResourceGroupManager::getSingleton().initialiseAllResourceGroups();
+
+    if (mPreloadGroups.empty())
+        return;
+
+    delete mResourceLoader;
+    mResourceLoader = new ResourceLoader(mJobSystem);
+    for (size_t i = 0; i < mPreloadGroups.size(); ++i)
+        mResourceLoader->addGroup(mPreloadGroups[i]);
+    mResourceLoader->start(mPreloadInBackground);
+
+    if (!mPreloadInBackground)
+        finishResourceLoading();
+}
+
+void ApplicationContext::finishResourceLoading()
+{
+    if (!mResourceLoader || mResourceLoader->isFinished())
+        return;
+
+    mResourceLoader->finish();
+    Ogre::LogManager::getSingleton().logMessage("preloaded resources\n" + mResourceLoader->describe());
 }
 
 void ApplicationContext::reconfigure(const Ogre::String &renderer, Ogre::NameValuePairList &options)
@@ -582,7 +809,8 @@ void ApplicationContext::pollEvents()
             }
             break;
         default:
-            _fireInputEvent(event);
+            if (!mReplay)
+                _fireInputEvent(event);
             break;
         }
     }
@@ -54,7 +54,12 @@ namespace Ogre {
     class OverlaySystem;
 }
 
+#include "OgreAsyncLog.h"
 #include "OgreInput.h"
+#include "OgreInputRecording.h"
+#include "OgreJobSystem.h"
+#include "OgreResourceLoader.h"
+#include "OgreTraceRecorder.h"
 #include "OgreWindowEventUtilities.h"
 
 /** \addtogroup Optional Optional Components
@@ -100,6 +105,60 @@ namespace Bites
             return mOverlaySystem;
         }
 
+        /// the job system for parallel work of the application. Available after createRoot.
+        JobSystem* getJobSystem() const {
+            return mJobSystem;
+        }
+
+        /**
+        Sets the number of job system workers in addition to the main thread.
+        Must be called before initApp. -1 (default) uses one per hardware thread.
+        */
+        void setNumWorkerThreads(int num) {
+            mNumWorkerThreads = num;
+        }
+
+        /**
+        Pins job system worker i to cpus[i % cpus.size()]. Must be called before initApp.
+        Empty (default) lets the OS place them.
+        */
+        void setWorkerCpus(const std::vector<int>& cpus) {
+            mWorkerCpus = cpus;
+        }
+
+        /**
+        Prepares the meshes and textures of @p groups on the job system after their
+        scripts were parsed by loadResources. With @p background, loading finishes
+        while the application sets up its scene, at the latest in startRendering.
+        Must be called before initApp.
+        */
+        void setResourcePreload(const Ogre::StringVector& groups, bool background = true) {
+            mPreloadGroups = groups;
+            mPreloadInBackground = background;
+        }
+
+        /// the preloaded resources with their timings, if any
+        ResourceLoader* getResourceLoader() const { return mResourceLoader; }
+
+        /// wait for all preloaded resources and load them on the calling thread
+        void finishResourceLoading();
+
+        /**
+        Writes ogre.log from a background thread, so logging never waits for the disk.
+        @param capacity messages that can be queued before new ones are dropped
+        Must be called before initApp.
+        */
+        void setAsyncLogging(bool enable, size_t capacity = 4096) {
+            mAsyncLogging = enable;
+            mAsyncLogCapacity = capacity;
+        }
+
+        /// the background writer of ogre.log, if any
+        AsyncLog* getAsyncLog() const { return mAsyncLog; }
+
+        /// drop every message below LML_CRITICAL of the default log, e.g. during measured frames
+        void setLogSuppressed(bool suppress);
+
         /**
         This function initializes the render system and resources.
         */
@@ -117,11 +176,40 @@ namespace Bites
         */
         void closeApp();
 
+        /**
+        Runs the render loop until Root::queueEndRendering is called. Unlike
+        Root::startRendering the frame time steps can come from a fixed clock or a replay.
+        @param fixedTimeStep seconds per frame. 0 uses the wall clock or the replayed steps.
+        */
+        void startRendering(Ogre::Real fixedTimeStep = 0);
+
+        /**
+        Records every input event dispatched by _fireInputEvent together with the
+        time step of each frame. The recording is written to @p path by closeApp.
+        */
+        void startInputRecording(const Ogre::String& path);
+
+        /**
+        Replays a recording made by startInputRecording. Live input is ignored while
+        replaying and rendering ends after the last recorded frame.
+        Must be called before startRendering.
+        */
+        bool startInputReplay(const Ogre::String& path);
+
+        bool isReplayingInput() const { return mReplay != NULL; }
+
+        /**
+        Records a timeline of the frame callbacks, Ogre::Profiler blocks, RTSS shader
+        generation and job system tasks. The trace is written to @p path by closeApp.
+        Must be called before initApp.
+        */
+        void startTracing(const Ogre::String& path);
+
+        /// the trace being recorded, if any
+        TraceRecorder* getTraceRecorder() const { return mTrace; }
+
         // callback interface copied from various listeners to be used by ApplicationContext
-        virtual bool frameStarted(const Ogre::FrameEvent& evt) {
-            pollEvents();
-            return true;
-        }
+        virtual bool frameStarted(const Ogre::FrameEvent& evt);
         virtual bool frameRenderingQueued(const Ogre::FrameEvent& evt);
         virtual bool frameEnded(const Ogre::FrameEvent& evt) { return true; }
         virtual void windowMoved(Ogre::RenderWindow* rw) {}
@@ -242,6 +330,29 @@ namespace Bites
         tbb::task_scheduler_init mTaskScheduler;
 #endif
 
+#ifdef OGRE_STATIC_LIB
+        StaticPluginLoader mStaticPluginLoader;
+#endif
+
+        JobSystem* mJobSystem;          // work-stealing job system
+        int mNumWorkerThreads;
+        std::vector<int> mWorkerCpus;
+
+        Ogre::StringVector mPreloadGroups;
+        bool mPreloadInBackground;
+        ResourceLoader* mResourceLoader; // resources being preloaded, if any
+
+        bool mAsyncLogging;
+        size_t mAsyncLogCapacity;
+        Ogre::LogManager* mLogManager;  // created before Root, if logging asynchronously
+        AsyncLog* mAsyncLog;
+        bool mLogSuppressed;
+#if OGRE_VERSION >= (13 << 16)
+        Ogre::LogMessageLevel mLogLevel; // before suppressing
+#else
+        Ogre::LoggingLevel mLogLevel;
+#endif
+
         Ogre::OverlaySystem* mOverlaySystem;  // Overlay system
 
         Ogre::FileSystemLayer* mFSLayer; // File system abstraction layer
@@ -256,6 +367,15 @@ namespace Bites
 
         std::set<InputListener*> mInputListeners;
 
+        InputRecording* mRecording;     // input being recorded, if any
+        Ogre::String mRecordingPath;
+        InputRecording* mReplay;        // input being replayed, if any
+        size_t mReplayFrame;
+
+        TraceRecorder* mTrace;          // timeline being recorded, if any
+        Ogre::String mTracePath;
+        Ogre::FrameListener* mTraceFrameListener; // forwards to this, recording each callback
+
 #ifdef OGRE_BUILD_COMPONENT_RTSHADERSYSTEM
         Ogre::RTShader::ShaderGenerator*       mShaderGenerator; // The Shader generator instance.
         SGTechniqueResolverListener*       mMaterialMgrListener; // Shader generator material manager listener.
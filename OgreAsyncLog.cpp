@@ -0,0 +1,91 @@
+/*
+ * OgreAsyncLog.cpp
+ */
+
+#include "OgreAsyncLog.h"
+
+#include "OgreThreadAffinity.h"
+#include "OgreTraceRecorder.h"
+
+#include <chrono>
+#include <ctime>
+
+namespace Bites {
+
+AsyncLog::AsyncLog(const Ogre::String& path, size_t capacity)
+    : mQueue(capacity), mFile(fopen(path.c_str(), "w")), mRunning(true), mQueued(0), mDropped(0)
+{
+    if (!mFile)
+        return;
+
+    mWriter = std::thread([this]() {
+        TraceRecorder::setThreadName("log writer");
+        resetCurrentThreadAffinity();
+        write();
+    });
+}
+
+AsyncLog::~AsyncLog()
+{
+    mRunning = false;
+    if (mWriter.joinable())
+        mWriter.join();
+
+    if (!mFile)
+        return;
+
+    if (size_t dropped = getDropped())
+        fprintf(mFile, "%zu log messages dropped, the queue of %zu was full\n", dropped, mQueue.capacity());
+    fclose(mFile);
+}
+
+void AsyncLog::messageLogged(const Ogre::String& message, Ogre::LogMessageLevel, bool, const Ogre::String&, bool&)
+{
+    if (!mFile)
+        return;
+
+    // the same prefix as the file output of Ogre::Log
+    char stamp[16];
+    time_t now = time(NULL);
+    struct tm local;
+#ifdef _WIN32
+    localtime_s(&local, &now);
+#else
+    localtime_r(&now, &local);
+#endif
+    strftime(stamp, sizeof(stamp), "%H:%M:%S: ", &local);
+
+    Ogre::String line;
+    line.reserve(message.size() + 12);
+    line.append(stamp).append(message).append("\n");
+
+    if (mQueue.push(std::move(line)))
+        mQueued.fetch_add(1, std::memory_order_relaxed);
+    else
+        mDropped.fetch_add(1, std::memory_order_relaxed);
+}
+
+void AsyncLog::write()
+{
+    Ogre::String line;
+    for (;;)
+    {
+        // check before draining, so nothing queued before the destructor is lost
+        bool running = mRunning;
+        bool wrote = false;
+        while (mQueue.pop(line))
+        {
+            fwrite(line.data(), 1, line.size(), mFile);
+            wrote = true;
+        }
+
+        if (wrote)
+            fflush(mFile);
+        else if (!running)
+            return;
+        else
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+}
+
+}
@@ -0,0 +1,64 @@
+/*
+ * OgreAsyncLog.h
+ *
+ * writes the messages of an Ogre::Log to disk from a background thread
+ */
+
+#ifndef SAMPLES_COMMON_INCLUDE_ASYNCLOG_H_
+#define SAMPLES_COMMON_INCLUDE_ASYNCLOG_H_
+
+#include "OgreBoundedQueue.h"
+#include "OgreLog.h"
+
+#include <atomic>
+#include <cstdio>
+#include <thread>
+
+/** \addtogroup Optional
+*  @{
+*/
+/** \addtogroup Bites
+*  @{
+*/
+namespace Bites {
+
+/**
+Listens to a log created with suppressFileOutput and writes its messages from a
+writer thread. The logging thread only formats the time stamp and moves the message
+into a bounded queue; when the queue is full the message is dropped and counted
+instead of waiting for the disk.
+*/
+class AsyncLog : public Ogre::LogListener
+{
+public:
+    /// opens @p path for writing and starts the writer thread
+    AsyncLog(const Ogre::String& path, size_t capacity = 4096);
+
+    /// writes the remaining messages and closes the file
+    ~AsyncLog();
+
+    bool isOpen() const { return mFile != NULL; }
+
+    void messageLogged(const Ogre::String& message, Ogre::LogMessageLevel lml, bool maskDebug,
+                       const Ogre::String& logName, bool& skipThisMessage);
+
+    /// messages queued since construction
+    size_t getQueued() const { return mQueued.load(std::memory_order_relaxed); }
+    /// messages lost to a full queue since construction
+    size_t getDropped() const { return mDropped.load(std::memory_order_relaxed); }
+
+private:
+    void write();
+
+    BoundedQueue<Ogre::String> mQueue;
+    FILE* mFile;
+    std::thread mWriter;
+    std::atomic<bool> mRunning;
+    std::atomic<size_t> mQueued;
+    std::atomic<size_t> mDropped;
+};
+}
+/** @} */
+/** @} */
+
+#endif /* SAMPLES_COMMON_INCLUDE_ASYNCLOG_H_ */
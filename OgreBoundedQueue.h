@@ -0,0 +1,123 @@
+/*
+ * OgreBoundedQueue.h
+ *
+ * fixed capacity lock-free queue for any number of producers and consumers
+ */
+
+#ifndef SAMPLES_COMMON_INCLUDE_BOUNDEDQUEUE_H_
+#define SAMPLES_COMMON_INCLUDE_BOUNDEDQUEUE_H_
+
+#include <atomic>
+#include <cstddef>
+#include <vector>
+
+/** \addtogroup Optional
+*  @{
+*/
+/** \addtogroup Bites
+*  @{
+*/
+namespace Bites {
+
+/**
+A ring of slots, each with a sequence number telling whether it is free for the
+producer of a given position or holds the value for the consumer of it. Producers
+and consumers claim positions with a compare and swap and never wait for each other,
+so push fails instead of blocking when the queue is full.
+
+The capacity is rounded up to a power of two.
+*/
+template <class T> class BoundedQueue
+{
+public:
+    explicit BoundedQueue(size_t capacity) : mSlots(roundUp(capacity)), mMask(mSlots.size() - 1)
+    {
+        for (size_t i = 0; i < mSlots.size(); ++i)
+            mSlots[i].sequence.store(i, std::memory_order_relaxed);
+        mHead.store(0, std::memory_order_relaxed);
+        mTail.store(0, std::memory_order_relaxed);
+    }
+
+    /// false if the queue is full, @p value is left untouched then
+    bool push(T&& value)
+    {
+        size_t pos = mTail.load(std::memory_order_relaxed);
+        for (;;)
+        {
+            Slot& slot = mSlots[pos & mMask];
+            size_t seq = slot.sequence.load(std::memory_order_acquire);
+            std::ptrdiff_t diff = std::ptrdiff_t(seq) - std::ptrdiff_t(pos);
+            if (diff == 0)
+            {
+                if (mTail.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed))
+                {
+                    slot.value = std::move(value);
+                    slot.sequence.store(pos + 1, std::memory_order_release);
+                    return true;
+                }
+            }
+            else if (diff < 0)
+                return false; // a full lap ahead of the consumers
+            else
+                pos = mTail.load(std::memory_order_relaxed);
+        }
+    }
+
+    /// false if the queue is empty
+    bool pop(T& value)
+    {
+        size_t pos = mHead.load(std::memory_order_relaxed);
+        for (;;)
+        {
+            Slot& slot = mSlots[pos & mMask];
+            size_t seq = slot.sequence.load(std::memory_order_acquire);
+            std::ptrdiff_t diff = std::ptrdiff_t(seq) - std::ptrdiff_t(pos + 1);
+            if (diff == 0)
+            {
+                if (mHead.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed))
+                {
+                    value = std::move(slot.value);
+                    slot.sequence.store(pos + mSlots.size(), std::memory_order_release);
+                    return true;
+                }
+            }
+            else if (diff < 0)
+                return false;
+            else
+                pos = mHead.load(std::memory_order_relaxed);
+        }
+    }
+
+    size_t capacity() const { return mSlots.size(); }
+
+private:
+    struct Slot
+    {
+        std::atomic<size_t> sequence;
+        T value;
+    };
+
+    static size_t roundUp(size_t n)
+    {
+        size_t ret = 2;
+        while (ret < n)
+            ret *= 2;
+        return ret;
+    }
+
+    std::vector<Slot> mSlots;
+    const size_t mMask;
+
+    // on separate cache lines, so producers and consumers do not invalidate each other.
+    // Padding rather than alignas, which C++11 new does not honour beyond max_align_t.
+    char mPad0[64];
+    std::atomic<size_t> mTail; // next position to push to
+    char mPad1[64 - sizeof(std::atomic<size_t>)];
+    std::atomic<size_t> mHead; // next position to pop from
+    char mPad2[64 - sizeof(std::atomic<size_t>)];
+};
+}
+/** @} */
+/** @} */
+
+#endif /* SAMPLES_COMMON_INCLUDE_BOUNDEDQUEUE_H_ */
@@ -0,0 +1,68 @@
+/*
+ * OgreInputRecording.cpp
+ */
+
+#include "OgreInputRecording.h"
+
+#include <algorithm>
+#include <fstream>
+#include <stdint.h>
+
+namespace Bites {
+
+static const char RECORDING_MAGIC[8] = {'O', 'G', 'R', 'E', 'I', 'N', 'P', '1'};
+
+bool InputRecording::save(const std::string& path) const
+{
+    std::ofstream out(path.c_str(), std::ios::binary);
+    if(!out.is_open())
+        return false;
+
+    uint32_t eventSize = sizeof(Event);
+    uint32_t numFrames = uint32_t(mFrames.size());
+    out.write(RECORDING_MAGIC, sizeof(RECORDING_MAGIC));
+    out.write((const char*)&eventSize, sizeof(eventSize));
+    out.write((const char*)&numFrames, sizeof(numFrames));
+
+    for(size_t i = 0; i < mFrames.size(); ++i)
+    {
+        const Frame& f = mFrames[i];
+        uint32_t numEvents = uint32_t(f.events.size());
+        out.write((const char*)&f.timeStep, sizeof(f.timeStep));
+        out.write((const char*)&numEvents, sizeof(numEvents));
+        if(numEvents)
+            out.write((const char*)&f.events[0], numEvents * sizeof(Event));
+    }
+
+    return out.good();
+}
+
+bool InputRecording::load(const std::string& path)
+{
+    std::ifstream in(path.c_str(), std::ios::binary);
+
+    char magic[sizeof(RECORDING_MAGIC)];
+    uint32_t eventSize = 0, numFrames = 0;
+    in.read(magic, sizeof(magic));
+    in.read((char*)&eventSize, sizeof(eventSize));
+    in.read((char*)&numFrames, sizeof(numFrames));
+
+    if(!in.good() || !std::equal(magic, magic + sizeof(magic), RECORDING_MAGIC) || eventSize != sizeof(Event))
+        return false;
+
+    mFrames.resize(numFrames);
+    for(size_t i = 0; i < mFrames.size(); ++i)
+    {
+        Frame& f = mFrames[i];
+        uint32_t numEvents = 0;
+        in.read((char*)&f.timeStep, sizeof(f.timeStep));
+        in.read((char*)&numEvents, sizeof(numEvents));
+        f.events.resize(numEvents);
+        if(numEvents)
+            in.read((char*)&f.events[0], numEvents * sizeof(Event));
+    }
+
+    return in.good();
+}
+
+}
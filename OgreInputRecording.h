@@ -0,0 +1,68 @@
+/*
+ * OgreInputRecording.h
+ *
+ * frame by frame recording of the dispatched input events and time steps
+ */
+
+#ifndef SAMPLES_COMMON_INCLUDE_INPUTRECORDING_H_
+#define SAMPLES_COMMON_INCLUDE_INPUTRECORDING_H_
+
+#include "OgreInput.h"
+
+#include <string>
+#include <vector>
+
+/** \addtogroup Optional
+*  @{
+*/
+/** \addtogroup Bites
+*  @{
+*/
+namespace Bites {
+/**
+the events are stored as raw bytes, so a recording is only portable between
+builds on the same platform and SDL version
+*/
+class InputRecording
+{
+public:
+    struct Frame
+    {
+        float timeStep; // seconds
+        std::vector<Event> events;
+    };
+
+    /// start a new frame that will receive all following events
+    void beginFrame(float timeStep)
+    {
+        Frame f;
+        f.timeStep = timeStep;
+        mFrames.push_back(f);
+        // only the first frame gets any, a frame of their own would shift every later one on replay
+        mFrames.back().events.swap(mEarlyEvents);
+    }
+
+    /// events before the first frame go to the first frame
+    void addEvent(const Event& evt)
+    {
+        if(mFrames.empty())
+            mEarlyEvents.push_back(evt);
+        else
+            mFrames.back().events.push_back(evt);
+    }
+
+    size_t getNumFrames() const { return mFrames.size(); }
+    const Frame& getFrame(size_t i) const { return mFrames[i]; }
+
+    bool save(const std::string& path) const;
+    bool load(const std::string& path);
+
+private:
+    std::vector<Frame> mFrames;
+    std::vector<Event> mEarlyEvents; // until the first beginFrame
+};
+}
+/** @} */
+/** @} */
+
+#endif /* SAMPLES_COMMON_INCLUDE_INPUTRECORDING_H_ */
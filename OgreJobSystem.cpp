@@ -0,0 +1,269 @@
+/*
+ * OgreJobSystem.cpp
+ */
+
+#include "OgreJobSystem.h"
+#include "OgreThreadAffinity.h"
+#include "OgreTraceRecorder.h"
+
+namespace Bites {
+
+namespace {
+// the job system and deque the current thread works on, if it is a worker
+thread_local const JobSystem* tlsJobSystem = NULL;
+thread_local size_t tlsSlot = 0;
+}
+
+TaskGraph::TaskId TaskGraph::add(const std::function<void()>& job)
+{
+    mNodes.emplace_back();
+    mNodes.back().job = job;
+    return mNodes.size() - 1;
+}
+
+void TaskGraph::precede(TaskId before, TaskId after)
+{
+    mNodes[before].successors.push_back(after);
+    mNodes[after].numPredecessors++;
+}
+
+JobSystem::JobSystem(int numWorkers, const std::vector<int>& cpus) : mCpus(cpus), mQueued(0), mQuit(false)
+{
+    startWorkers(numWorkers);
+    resetStats();
+}
+
+JobSystem::~JobSystem()
+{
+    stopWorkers();
+}
+
+void JobSystem::startWorkers(int numWorkers)
+{
+    if(numWorkers < 0)
+        numWorkers = std::max(1u, std::thread::hardware_concurrency()) - 1;
+
+    mQuit = false;
+    mWorkers.clear();
+    for(int i = 0; i <= numWorkers; ++i)
+    {
+        mWorkers.push_back(std::unique_ptr<Worker>(new Worker()));
+        mWorkers.back()->jobs = 0;
+        mWorkers.back()->steals = 0;
+        mWorkers.back()->busyNs = 0;
+    }
+
+    for(int i = 0; i < numWorkers; ++i)
+        mWorkers[i]->thread = std::thread(&JobSystem::workerLoop, this, size_t(i));
+}
+
+void JobSystem::stopWorkers()
+{
+    {
+        std::lock_guard<std::mutex> lock(mSleepMutex);
+        mQuit = true;
+    }
+    mWakeUp.notify_all();
+
+    for(size_t i = 0; i < getNumWorkers(); ++i)
+        mWorkers[i]->thread.join();
+}
+
+void JobSystem::setNumWorkers(int numWorkers)
+{
+    stopWorkers();
+    // keep the counts until resetStats, e.g. over all configurations of the autotuner
+    mRetired = getStats();
+    startWorkers(numWorkers);
+}
+
+size_t JobSystem::currentSlot() const
+{
+    return tlsJobSystem == this ? tlsSlot : mWorkers.size() - 1;
+}
+
+void JobSystem::push(const Task& task)
+{
+    Worker& w = *mWorkers[currentSlot()];
+    {
+        std::lock_guard<std::mutex> lock(w.mutex);
+        w.tasks.push_back(task);
+    }
+    mQueued++;
+
+    // pairs with the predicate check in workerLoop, so the wake up can not get lost
+    { std::lock_guard<std::mutex> lock(mSleepMutex); }
+    mWakeUp.notify_one();
+}
+
+bool JobSystem::tryRunOne(size_t slot)
+{
+    Task task;
+    bool found = false;
+    bool stolen = false;
+
+    {
+        Worker& own = *mWorkers[slot];
+        std::lock_guard<std::mutex> lock(own.mutex);
+        if(!own.tasks.empty())
+        {
+            task = own.tasks.back();
+            own.tasks.pop_back();
+            found = true;
+        }
+    }
+
+    for(size_t i = 1; !found && i < mWorkers.size(); ++i)
+    {
+        Worker& victim = *mWorkers[(slot + i) % mWorkers.size()];
+        std::lock_guard<std::mutex> lock(victim.mutex);
+        if(!victim.tasks.empty())
+        {
+            task = victim.tasks.front();
+            victim.tasks.pop_front();
+            found = stolen = true;
+        }
+    }
+
+    if(!found)
+        return false;
+
+    mQueued--;
+
+    Worker& self = *mWorkers[slot];
+    auto start = std::chrono::steady_clock::now();
+    task.fn();
+    auto end = std::chrono::steady_clock::now();
+    self.busyNs += std::chrono::duration_cast<std::chrono::nanoseconds>(end - start).count();
+    self.jobs++;
+    self.steals += stolen;
+
+    if(TraceRecorder* trace = TraceRecorder::getActive())
+        trace->addEvent(stolen ? "job (stolen)" : "job", "jobs", start, end);
+
+    (*task.pending)--;
+    return true;
+}
+
+void JobSystem::wait(std::atomic<size_t>& pending)
+{
+    size_t slot = currentSlot();
+    while(pending > 0)
+    {
+        if(!tryRunOne(slot))
+            std::this_thread::yield();
+    }
+}
+
+void JobSystem::workerLoop(size_t slot)
+{
+    tlsJobSystem = this;
+    tlsSlot = slot;
+    TraceRecorder::setThreadName("worker " + std::to_string(slot));
+    if(!mCpus.empty())
+        pinCurrentThread(mCpus[slot % mCpus.size()]);
+
+    while(true)
+    {
+        if(tryRunOne(slot))
+            continue;
+
+        std::unique_lock<std::mutex> lock(mSleepMutex);
+        mWakeUp.wait(lock, [this]() { return mQuit || mQueued > 0; });
+        if(mQuit)
+            return;
+    }
+}
+
+void JobSystem::parallel_for(size_t begin, size_t end, size_t grain,
+                             const std::function<void(size_t, size_t)>& fn)
+{
+    if(begin >= end)
+        return;
+
+    if(grain == 0)
+        grain = std::max<size_t>(1, (end - begin) / (4 * mWorkers.size()));
+
+    std::atomic<size_t> pending((end - begin + grain - 1) / grain);
+    for(size_t b = begin; b < end; b += grain)
+    {
+        size_t e = std::min(end, b + grain);
+        Task t = {[&fn, b, e]() { fn(b, e); }, &pending};
+        push(t);
+    }
+
+    wait(pending);
+}
+
+void JobSystem::run(TaskGraph& graph)
+{
+    std::atomic<size_t> pending(graph.size());
+
+    // submits a node and, once it finished, all successors that became ready
+    std::function<void(TaskGraph::TaskId)> submit = [&](TaskGraph::TaskId id) {
+        Task t = {[&, id]() {
+            TaskGraph::Node& n = graph.mNodes[id];
+            n.job();
+            for(size_t i = 0; i < n.successors.size(); ++i)
+            {
+                if(--graph.mNodes[n.successors[i]].pending == 0)
+                    submit(n.successors[i]);
+            }
+        }, &pending};
+        push(t);
+    };
+
+    for(size_t i = 0; i < graph.size(); ++i)
+        graph.mNodes[i].pending = graph.mNodes[i].numPredecessors;
+
+    for(size_t i = 0; i < graph.size(); ++i)
+    {
+        if(graph.mNodes[i].numPredecessors == 0)
+            submit(i);
+    }
+
+    wait(pending);
+}
+
+std::vector<JobSystem::WorkerStats> JobSystem::getStats() const
+{
+    double wall = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - mStatsStart).count();
+
+    // the workers by slot, also the ones replaced by setNumWorkers, and the external threads last
+    size_t threads = std::max(getNumWorkers(), mRetired.empty() ? 0 : mRetired.size() - 1);
+    WorkerStats zero = {0, 0, 0, 0};
+    std::vector<WorkerStats> ret(threads + 1, zero);
+    for(size_t i = 0; i < mWorkers.size(); ++i)
+    {
+        const Worker& w = *mWorkers[i];
+        WorkerStats& s = i < getNumWorkers() ? ret[i] : ret.back();
+        s.jobs += w.jobs;
+        s.steals += w.steals;
+        s.busyTime += w.busyNs / 1e6;
+    }
+    for(size_t i = 0; i < mRetired.size(); ++i)
+    {
+        WorkerStats& s = i + 1 < mRetired.size() ? ret[i] : ret.back();
+        s.jobs += mRetired[i].jobs;
+        s.steals += mRetired[i].steals;
+        s.busyTime += mRetired[i].busyTime;
+    }
+
+    for(size_t i = 0; i < ret.size(); ++i)
+        ret[i].utilisation = wall > 0 ? ret[i].busyTime / wall : 0;
+    return ret;
+}
+
+void JobSystem::resetStats()
+{
+    for(size_t i = 0; i < mWorkers.size(); ++i)
+    {
+        mWorkers[i]->jobs = 0;
+        mWorkers[i]->steals = 0;
+        mWorkers[i]->busyNs = 0;
+    }
+    mRetired.clear();
+    mStatsStart = std::chrono::steady_clock::now();
+}
+
+}
@@ -0,0 +1,143 @@
+/*
+ * OgreJobSystem.h
+ *
+ * work-stealing job system owned by the ApplicationContext
+ */
+
+#ifndef SAMPLES_COMMON_INCLUDE_JOBSYSTEM_H_
+#define SAMPLES_COMMON_INCLUDE_JOBSYSTEM_H_
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+/** \addtogroup Optional
+*  @{
+*/
+/** \addtogroup Bites
+*  @{
+*/
+namespace Bites {
+
+/**
+A set of jobs with dependencies between them. Can be run repeatedly.
+*/
+class TaskGraph
+{
+public:
+    typedef size_t TaskId;
+
+    TaskId add(const std::function<void()>& job);
+
+    /// @p after is not started before @p before finished
+    void precede(TaskId before, TaskId after);
+
+    size_t size() const { return mNodes.size(); }
+
+private:
+    friend class JobSystem;
+
+    struct Node
+    {
+        std::function<void()> job;
+        std::vector<TaskId> successors;
+        size_t numPredecessors = 0;
+        std::atomic<size_t> pending;
+    };
+    std::deque<Node> mNodes;
+};
+
+/**
+Every worker owns a deque of jobs. New jobs are pushed to the deque of the
+submitting thread, which pops from the back while idle workers steal from the
+front of the others. Threads that wait for jobs to finish help executing them.
+*/
+class JobSystem
+{
+public:
+    /**
+    @param numWorkers threads in addition to the calling one. -1 uses one per hardware thread.
+    @param cpus if given, worker i is pinned to cpus[i % cpus.size()]
+    */
+    explicit JobSystem(int numWorkers = -1, const std::vector<int>& cpus = std::vector<int>());
+    ~JobSystem();
+
+    size_t getNumWorkers() const { return mWorkers.size() - 1; }
+
+    /// stop all workers and start @p numWorkers new ones. No jobs may be running. The statistics are kept.
+    void setNumWorkers(int numWorkers);
+
+    /**
+    Calls @p fn(chunkBegin, chunkEnd) for chunks of [begin, end) in parallel and
+    returns when all of them are done.
+    @param grain chunk size. 0 picks about four chunks per thread.
+    */
+    void parallel_for(size_t begin, size_t end, size_t grain,
+                      const std::function<void(size_t, size_t)>& fn);
+
+    /// run all tasks of @p graph respecting their dependencies and wait for them
+    void run(TaskGraph& graph);
+
+    struct WorkerStats
+    {
+        size_t jobs;        // jobs executed
+        size_t steals;      // jobs taken from another deque
+        double busyTime;    // ms spent executing jobs
+        double utilisation; // busyTime relative to the time since resetStats
+    };
+
+    /**
+    one entry per worker slot used since resetStats, the last one accumulates all threads
+    outside the job system
+    */
+    std::vector<WorkerStats> getStats() const;
+    void resetStats();
+
+private:
+    struct Task
+    {
+        std::function<void()> fn;
+        std::atomic<size_t>* pending; // decremented once fn returned
+    };
+
+    struct Worker
+    {
+        std::mutex mutex;
+        std::deque<Task> tasks;
+        std::thread thread;
+        std::atomic<size_t> jobs;
+        std::atomic<size_t> steals;
+        std::atomic<uint64_t> busyNs;
+    };
+
+    size_t currentSlot() const;
+    void push(const Task& task);
+    bool tryRunOne(size_t slot);
+    void wait(std::atomic<size_t>& pending);
+    void workerLoop(size_t slot);
+    void startWorkers(int numWorkers);
+    void stopWorkers();
+
+    std::vector<std::unique_ptr<Worker> > mWorkers; // the last slot is shared by external threads
+    std::vector<int> mCpus;
+
+    std::atomic<size_t> mQueued;
+    std::mutex mSleepMutex;
+    std::condition_variable mWakeUp;
+    bool mQuit;
+
+    std::chrono::steady_clock::time_point mStatsStart;
+    std::vector<WorkerStats> mRetired; // of the workers before the last setNumWorkers
+};
+}
+/** @} */
+/** @} */
+
+#endif /* SAMPLES_COMMON_INCLUDE_JOBSYSTEM_H_ */
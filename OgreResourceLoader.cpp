@@ -0,0 +1,233 @@
+/*
+ * OgreResourceLoader.cpp
+ */
+
+#include "OgreResourceLoader.h"
+
+#include "OgreJobSystem.h"
+#include "OgreThreadAffinity.h"
+#include "OgreTraceRecorder.h"
+
+#include "OgreLogManager.h"
+#include "OgreMaterialManager.h"
+#include "OgreMeshManager.h"
+#include "OgreResourceGroupManager.h"
+#include "OgreTechnique.h"
+#include "OgreTextureManager.h"
+#include "OgreTextureUnitState.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <set>
+
+namespace Bites {
+
+namespace {
+typedef std::chrono::steady_clock Clock;
+
+double msSince(Clock::time_point start)
+{
+    return std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+}
+}
+
+ResourceLoader::ResourceLoader(JobSystem* jobs)
+    : mJobs(jobs), mPrepareWallTime(0), mFinishWallTime(0), mFinished(false)
+{
+}
+
+ResourceLoader::~ResourceLoader()
+{
+    if (mThread.joinable())
+        mThread.join();
+}
+
+void ResourceLoader::addGroup(const Ogre::String& group)
+{
+    using namespace Ogre;
+    ResourceGroupManager& rgm = ResourceGroupManager::getSingleton();
+
+    StringVectorPtr meshes = rgm.findResourceNames(group, "*.mesh");
+    for (size_t i = 0; i < meshes->size(); ++i)
+        add(MeshManager::getSingleton().createOrRetrieve((*meshes)[i], group).first);
+
+#if OGRE_VERSION_MAJOR != 2
+    // the textures are only known from the materials, which also tell their type
+    std::set<String> textures;
+    ResourceManager::ResourceMapIterator it = MaterialManager::getSingleton().getResourceIterator();
+    while (it.hasMoreElements())
+    {
+        Material* mat = static_cast<Material*>(it.getNext().get());
+        if (mat->getGroup() != group)
+            continue;
+
+        for (unsigned short t = 0; t < mat->getNumTechniques(); ++t)
+        {
+            Technique* tech = mat->getTechnique(t);
+            for (unsigned short p = 0; p < tech->getNumPasses(); ++p)
+            {
+                Pass* pass = tech->getPass(p);
+                for (unsigned short u = 0; u < pass->getNumTextureUnitStates(); ++u)
+                {
+                    TextureUnitState* tus = pass->getTextureUnitState(u);
+                    if (tus->getContentType() != TextureUnitState::CONTENT_NAMED)
+                        continue;
+
+                    for (unsigned int f = 0; f < tus->getNumFrames(); ++f)
+                    {
+                        const String& name = tus->getFrameTextureName(f);
+                        if (name.empty() || !textures.insert(name).second || !rgm.resourceExists(group, name))
+                            continue;
+                        add(TextureManager::getSingleton()
+                                .createOrRetrieve(name, group, false, 0, 0, tus->getTextureType())
+                                .first);
+                    }
+                }
+            }
+        }
+    }
+#endif
+}
+
+void ResourceLoader::add(const Ogre::ResourcePtr& resource)
+{
+    Item item = {resource, 0, 0, false};
+    mItems.push_back(item);
+}
+
+void ResourceLoader::prepare(size_t index)
+{
+    Item& item = mItems[index];
+    TraceScope trace("prepare", "resources");
+    if (trace.isRecording())
+        trace.setDetail(item.resource->getName());
+
+    Clock::time_point start = Clock::now();
+    try
+    {
+        item.resource->prepare(true);
+    }
+    catch (Ogre::Exception& e)
+    {
+        // load reports it again on the main thread
+        item.failed = true;
+        Ogre::LogManager::getSingleton().logMessage("preparing " + item.resource->getName() +
+                                                    " failed: " + e.getDescription(), Ogre::LML_CRITICAL);
+    }
+    item.prepareTime = msSince(start);
+
+    std::lock_guard<std::mutex> lock(mMutex);
+    mReady.push_back(index);
+    mPrepared.notify_one();
+}
+
+void ResourceLoader::start(bool background)
+{
+    Clock::time_point start = Clock::now();
+    // with 3 the resource managers take no locks
+#if OGRE_THREAD_SUPPORT == 1 || OGRE_THREAD_SUPPORT == 2
+    mThread = std::thread([this, start]() {
+        TraceRecorder::setThreadName("resource loader");
+        resetCurrentThreadAffinity();
+
+        mJobs->parallel_for(0, mItems.size(), 1, [this](size_t begin, size_t end) {
+            for (size_t i = begin; i < end; ++i)
+                prepare(i);
+        });
+        mPrepareWallTime = msSince(start);
+    });
+
+    if (background)
+        return;
+
+    mThread.join();
+#else
+    // resource managers are not thread safe
+    for (size_t i = 0; i < mItems.size(); ++i)
+        prepare(i);
+    mPrepareWallTime = msSince(start);
+#endif
+}
+
+void ResourceLoader::finish()
+{
+    Clock::time_point start = Clock::now();
+    for (size_t loaded = 0; loaded < mItems.size();)
+    {
+        std::vector<size_t> ready;
+        {
+            std::unique_lock<std::mutex> lock(mMutex);
+            mPrepared.wait(lock, [this]() { return !mReady.empty(); });
+            ready.swap(mReady);
+        }
+
+        for (size_t i = 0; i < ready.size(); ++i, ++loaded)
+        {
+            Item& item = mItems[ready[i]];
+            TraceScope trace("load", "resources");
+            if (trace.isRecording())
+                trace.setDetail(item.resource->getName());
+
+            Clock::time_point begin = Clock::now();
+            try
+            {
+                item.resource->load();
+            }
+            catch (Ogre::Exception& e)
+            {
+                item.failed = true;
+                Ogre::LogManager::getSingleton().logMessage("loading " + item.resource->getName() +
+                                                            " failed: " + e.getDescription(), Ogre::LML_CRITICAL);
+            }
+            item.loadTime = msSince(begin);
+        }
+    }
+
+    if (mThread.joinable())
+        mThread.join();
+    mFinishWallTime = msSince(start);
+    mFinished = true;
+}
+
+Ogre::String ResourceLoader::describe(size_t maxRows) const
+{
+    double prepare = 0, load = 0;
+    size_t bytes = 0, failed = 0;
+    std::vector<const Item*> sorted;
+    for (size_t i = 0; i < mItems.size(); ++i)
+    {
+        prepare += mItems[i].prepareTime;
+        load += mItems[i].loadTime;
+        bytes += mItems[i].resource->getSize();
+        failed += mItems[i].failed;
+        sorted.push_back(&mItems[i]);
+    }
+    std::sort(sorted.begin(), sorted.end(), [](const Item* a, const Item* b) {
+        return a->prepareTime + a->loadTime > b->prepareTime + b->loadTime;
+    });
+
+    char line[256];
+    Ogre::String ret;
+    snprintf(line, sizeof(line),
+             "%zu resources (%zu failed), %.1f MiB: prepare %.2f ms in %.2f ms wall (%.1fx), load %.2f ms, "
+             "finish waited %.2f ms\n",
+             mItems.size(), failed, bytes / 1048576.0, prepare, mPrepareWallTime,
+             mPrepareWallTime > 0 ? prepare / mPrepareWallTime : 0, load, mFinishWallTime - load);
+    ret += line;
+
+    snprintf(line, sizeof(line), "%-10s %-40s %10s %12s %12s\n", "type", "name", "KiB", "prepare (ms)",
+             "load (ms)");
+    ret += line;
+    for (size_t i = 0; i < std::min(maxRows, sorted.size()); ++i)
+    {
+        const Item& item = *sorted[i];
+        snprintf(line, sizeof(line), "%-10s %-40s %10.1f %12.3f %12.3f%s\n",
+                 item.resource->getCreator()->getResourceType().c_str(), item.resource->getName().c_str(),
+                 item.resource->getSize() / 1024.0, item.prepareTime, item.loadTime, item.failed ? " failed" : "");
+        ret += line;
+    }
+    return ret;
+}
+
+}
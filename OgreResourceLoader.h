@@ -0,0 +1,88 @@
+/*
+ * OgreResourceLoader.h
+ *
+ * prepares resources on the job system and loads them on the main thread
+ */
+
+#ifndef SAMPLES_COMMON_INCLUDE_RESOURCELOADER_H_
+#define SAMPLES_COMMON_INCLUDE_RESOURCELOADER_H_
+
+#include "OgreResource.h"
+
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+/** \addtogroup Optional
+*  @{
+*/
+/** \addtogroup Bites
+*  @{
+*/
+namespace Bites {
+
+class JobSystem;
+
+/**
+Resource::prepare reads and decodes the file, e.g. parses a mesh or decompresses an
+image, and needs no render system. Only Resource::load creates the GPU buffers. So
+every resource is prepared by a job while the main thread loads the ones prepared
+so far, in the order they finish.
+
+Preparing in parallel needs the resource managers locked, i.e. Ogre built with
+OGRE_CONFIG_THREADS 1 or 2. Otherwise, including the default 3, start prepares all
+resources serially before returning.
+*/
+class ResourceLoader
+{
+public:
+    struct Item
+    {
+        Ogre::ResourcePtr resource;
+        double prepareTime; // ms on the preparing thread
+        double loadTime;    // ms on the main thread
+        bool failed;
+    };
+
+    explicit ResourceLoader(JobSystem* jobs);
+    ~ResourceLoader();
+
+    /// the meshes in @p group and the textures its materials use. Call after its scripts were parsed.
+    void addGroup(const Ogre::String& group);
+
+    void add(const Ogre::ResourcePtr& resource);
+
+    /// start preparing. With @p background it returns immediately, otherwise once all are prepared.
+    void start(bool background);
+
+    /// load every resource on the calling thread as soon as it is prepared. Call after start.
+    void finish();
+
+    bool isFinished() const { return mFinished; }
+
+    const std::vector<Item>& getItems() const { return mItems; }
+
+    /// totals and the @p maxRows slowest resources
+    Ogre::String describe(size_t maxRows = 20) const;
+
+private:
+    void prepare(size_t index);
+
+    JobSystem* mJobs;
+    std::vector<Item> mItems;
+    std::thread mThread;
+
+    std::mutex mMutex;
+    std::condition_variable mPrepared;
+    std::vector<size_t> mReady; // prepared, but not loaded yet
+
+    double mPrepareWallTime; // ms from start until the last one was prepared
+    double mFinishWallTime;  // ms the main thread spent in finish
+    bool mFinished;
+};
+}
+/** @} */
+/** @} */
+
+#endif /* SAMPLES_COMMON_INCLUDE_RESOURCELOADER_H_ */
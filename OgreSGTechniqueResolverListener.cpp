@@ -1,6 +1,7 @@
 #include "OgreSGTechniqueResolverListener.h"
 
 #include "OgreTechnique.h"
+#include "OgreTraceRecorder.h"
 
 namespace Bites {
 
@@ -15,6 +16,9 @@ Ogre::Technique *SGTechniqueResolverListener::handleSchemeNotFound(unsigned shor
         return NULL;
     }
     // Case this is the default shader generator scheme.
+    TraceScope trace("RTSS technique", "rtss");
+    if (trace.isRecording())
+        trace.setDetail(originalMaterial->getName());
 
     // Create shader generated technique for this material.
     bool techniqueCreated = mShaderGenerator->createShaderBasedTechnique(
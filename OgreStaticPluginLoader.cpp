@@ -0,0 +1,62 @@
+/*
+ * OgreStaticPluginLoader.cpp
+ */
+
+#include "OgreStaticPluginLoader.h"
+
+#include "OgreBuildSettings.h"
+#include "OgreRoot.h"
+
+#ifdef OGRE_STATIC_LIB
+#   if defined(OGRE_BUILD_RENDERSYSTEM_GL3PLUS)
+#       include "OgreGL3PlusPlugin.h"
+#   elif defined(OGRE_BUILD_RENDERSYSTEM_GL)
+#       include "OgreGLPlugin.h"
+#   elif defined(OGRE_BUILD_RENDERSYSTEM_D3D11)
+#       include "OgreD3D11Plugin.h"
+#   endif
+#   if defined(OGRE_BUILD_PLUGIN_STBI)
+#       include "OgreSTBICodec.h"
+#   elif defined(OGRE_BUILD_PLUGIN_FREEIMAGE)
+#       include "OgreFreeImageCodec.h"
+#   endif
+#   ifdef OGRE_BUILD_PLUGIN_DOT_SCENE
+#       include "OgreDotSceneLoader.h"
+#   endif
+#endif
+
+namespace Bites {
+
+void StaticPluginLoader::load()
+{
+#ifdef OGRE_STATIC_LIB
+    using namespace Ogre;
+#   if defined(OGRE_BUILD_RENDERSYSTEM_GL3PLUS)
+    mPlugins.push_back(OGRE_NEW GL3PlusPlugin());
+#   elif defined(OGRE_BUILD_RENDERSYSTEM_GL)
+    mPlugins.push_back(OGRE_NEW GLPlugin());
+#   elif defined(OGRE_BUILD_RENDERSYSTEM_D3D11)
+    mPlugins.push_back(OGRE_NEW D3D11Plugin());
+#   endif
+#   if defined(OGRE_BUILD_PLUGIN_STBI)
+    mPlugins.push_back(OGRE_NEW STBIPlugin());
+#   elif defined(OGRE_BUILD_PLUGIN_FREEIMAGE)
+    mPlugins.push_back(OGRE_NEW FreeImagePlugin());
+#   endif
+#   ifdef OGRE_BUILD_PLUGIN_DOT_SCENE
+    mPlugins.push_back(OGRE_NEW DotScenePlugin());
+#   endif
+
+    for (size_t i = 0; i < mPlugins.size(); ++i)
+        Root::getSingleton().installPlugin(mPlugins[i]);
+#endif
+}
+
+void StaticPluginLoader::unload()
+{
+    for (size_t i = 0; i < mPlugins.size(); ++i)
+        OGRE_DELETE mPlugins[i];
+    mPlugins.clear();
+}
+
+}
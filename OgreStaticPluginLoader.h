@@ -0,0 +1,44 @@
+/*
+ * OgreStaticPluginLoader.h
+ *
+ * installs the plugins linked into a static build
+ */
+
+#ifndef SAMPLES_COMMON_INCLUDE_STATICPLUGINLOADER_H_
+#define SAMPLES_COMMON_INCLUDE_STATICPLUGINLOADER_H_
+
+#include "OgrePlugin.h"
+
+#include <vector>
+
+/** \addtogroup Optional
+*  @{
+*/
+/** \addtogroup Bites
+*  @{
+*/
+namespace Bites {
+
+/**
+With OGRE_STATIC_LIB there is no plugins.cfg to load. Unlike the loader of the Ogre
+samples this does not install every plugin Ogre was built with, only what the
+benchmark uses: the first of GL3Plus, GL and D3D11, an image codec and the
+DotScene loader. CMakeLists.txt links the same set.
+*/
+class StaticPluginLoader
+{
+public:
+    /// install the plugins into Root. Call after creating it.
+    void load();
+
+    /// delete the plugins. Call after deleting Root, which uninstalls them.
+    void unload();
+
+private:
+    std::vector<Ogre::Plugin*> mPlugins;
+};
+}
+/** @} */
+/** @} */
+
+#endif /* SAMPLES_COMMON_INCLUDE_STATICPLUGINLOADER_H_ */
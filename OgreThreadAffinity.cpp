@@ -0,0 +1,228 @@
+/*
+ * OgreThreadAffinity.cpp
+ */
+
+#include "OgreThreadAffinity.h"
+
+#include <algorithm>
+#include <cstdlib>
+#include <fstream>
+#include <set>
+#include <sstream>
+#include <thread>
+
+#if defined(__linux__)
+#include <pthread.h>
+#include <sched.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#elif defined(_WIN32)
+#include <windows.h>
+#endif
+
+namespace Bites {
+
+namespace {
+std::string readLine(const std::string& path)
+{
+    std::ifstream in(path.c_str());
+    std::string line;
+    std::getline(in, line);
+    return line;
+}
+
+#if defined(__linux__)
+// the mask the process was started with, e.g. by taskset
+struct ProcessMask
+{
+    cpu_set_t set;
+    ProcessMask() { sched_getaffinity(0, sizeof(set), &set); }
+} sProcessMask;
+#endif
+
+int readInt(const std::string& path, int fallback)
+{
+    std::string line = readLine(path);
+    return line.empty() ? fallback : atoi(line.c_str());
+}
+}
+
+std::vector<int> parseCpuList(const std::string& list)
+{
+    std::vector<int> ret;
+    std::istringstream in(list);
+    std::string range;
+    while(std::getline(in, range, ','))
+    {
+        if(range.empty())
+            continue;
+
+        size_t dash = range.find('-');
+        int first = atoi(range.c_str());
+        int last = dash == std::string::npos ? first : atoi(range.c_str() + dash + 1);
+        for(int i = first; i <= last; ++i)
+            ret.push_back(i);
+    }
+    return ret;
+}
+
+std::string formatCpuList(std::vector<int> cpus)
+{
+    std::sort(cpus.begin(), cpus.end());
+    cpus.erase(std::unique(cpus.begin(), cpus.end()), cpus.end());
+
+    std::string ret;
+    for(size_t i = 0; i < cpus.size();)
+    {
+        size_t j = i;
+        while(j + 1 < cpus.size() && cpus[j + 1] == cpus[j] + 1)
+            ++j;
+
+        ret += (ret.empty() ? "" : ",") + std::to_string(cpus[i]);
+        if(j > i)
+            ret += "-" + std::to_string(cpus[j]);
+        i = j + 1;
+    }
+    return ret;
+}
+
+CpuTopology CpuTopology::detect()
+{
+    CpuTopology topo;
+
+#if defined(__linux__)
+    const std::string sys = "/sys/devices/system/";
+    std::vector<int> online = parseCpuList(readLine(sys + "cpu/online"));
+    for(size_t i = 0; i < online.size(); ++i)
+    {
+        std::string dir = sys + "cpu/cpu" + std::to_string(online[i]) + "/topology/";
+        Cpu c = {online[i], readInt(dir + "core_id", online[i]), readInt(dir + "physical_package_id", 0), 0};
+        topo.cpus.push_back(c);
+    }
+
+    std::vector<int> nodes = parseCpuList(readLine(sys + "node/online"));
+    for(size_t n = 0; n < nodes.size(); ++n)
+    {
+        std::vector<int> local = parseCpuList(readLine(sys + "node/node" + std::to_string(nodes[n]) + "/cpulist"));
+        for(size_t i = 0; i < topo.cpus.size(); ++i)
+        {
+            if(std::find(local.begin(), local.end(), topo.cpus[i].id) != local.end())
+                topo.cpus[i].numaNode = nodes[n];
+        }
+    }
+#endif
+
+    if(topo.cpus.empty())
+    {
+        for(int i = 0, n = std::max(1u, std::thread::hardware_concurrency()); i < n; ++i)
+        {
+            Cpu c = {i, i, 0, 0};
+            topo.cpus.push_back(c);
+        }
+    }
+
+    return topo;
+}
+
+std::vector<int> CpuTopology::cpusOfNode(int node) const
+{
+    std::vector<int> ret;
+    for(size_t i = 0; i < cpus.size(); ++i)
+    {
+        if(cpus[i].numaNode == node)
+            ret.push_back(cpus[i].id);
+    }
+    return ret;
+}
+
+int CpuTopology::nodeOfCpu(int cpu) const
+{
+    for(size_t i = 0; i < cpus.size(); ++i)
+    {
+        if(cpus[i].id == cpu)
+            return cpus[i].numaNode;
+    }
+    return -1;
+}
+
+std::string CpuTopology::describe() const
+{
+    std::set<int> nodes;
+    for(size_t i = 0; i < cpus.size(); ++i)
+        nodes.insert(cpus[i].numaNode);
+
+    std::ostringstream out;
+    for(std::set<int>::iterator n = nodes.begin(); n != nodes.end(); ++n)
+    {
+        std::set<int> packages;
+        std::set<std::pair<int, int> > cores;
+        for(size_t i = 0; i < cpus.size(); ++i)
+        {
+            if(cpus[i].numaNode != *n)
+                continue;
+            packages.insert(cpus[i].package);
+            cores.insert(std::make_pair(cpus[i].package, cpus[i].core));
+        }
+
+        std::vector<int> pkgs(packages.begin(), packages.end());
+        out << "numa node " << *n << ": package " << formatCpuList(pkgs) << ", " << cores.size() << " cores, cpus "
+            << formatCpuList(cpusOfNode(*n)) << "\n";
+    }
+    return out.str();
+}
+
+bool pinCurrentThread(int cpu)
+{
+#if defined(__linux__)
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    CPU_SET(cpu, &set);
+    return pthread_setaffinity_np(pthread_self(), sizeof(set), &set) == 0;
+#elif defined(_WIN32)
+    return cpu < 64 && SetThreadAffinityMask(GetCurrentThread(), DWORD_PTR(1) << cpu) != 0;
+#else
+    return false;
+#endif
+}
+
+bool resetCurrentThreadAffinity()
+{
+#if defined(__linux__)
+    return pthread_setaffinity_np(pthread_self(), sizeof(sProcessMask.set), &sProcessMask.set) == 0;
+#elif defined(_WIN32)
+    DWORD_PTR process, system;
+    return GetProcessAffinityMask(GetCurrentProcess(), &process, &system) &&
+           SetThreadAffinityMask(GetCurrentThread(), process) != 0;
+#else
+    return false;
+#endif
+}
+
+int getCurrentCpu()
+{
+#if defined(__linux__)
+    return sched_getcpu();
+#elif defined(_WIN32)
+    return int(GetCurrentProcessorNumber());
+#else
+    return -1;
+#endif
+}
+
+bool setPreferredMemoryNode(int node)
+{
+#if defined(__linux__) && defined(SYS_set_mempolicy)
+    // from linux/mempolicy.h, which is not always installed
+    const int MPOL_PREFERRED = 1;
+
+    if(node < 0 || node >= 1024)
+        return false;
+    unsigned long mask[1024 / (8 * sizeof(unsigned long))] = {};
+    mask[node / (8 * sizeof(unsigned long))] = 1UL << (node % (8 * sizeof(unsigned long)));
+    return syscall(SYS_set_mempolicy, MPOL_PREFERRED, mask, 1024UL) == 0;
+#else
+    return false;
+#endif
+}
+
+}
@@ -0,0 +1,74 @@
+/*
+ * OgreThreadAffinity.h
+ *
+ * CPU topology, thread pinning and NUMA memory placement
+ */
+
+#ifndef SAMPLES_COMMON_INCLUDE_THREADAFFINITY_H_
+#define SAMPLES_COMMON_INCLUDE_THREADAFFINITY_H_
+
+#include <string>
+#include <vector>
+
+/** \addtogroup Optional
+*  @{
+*/
+/** \addtogroup Bites
+*  @{
+*/
+namespace Bites {
+
+/**
+The logical CPUs of the machine as reported by /sys on Linux. Elsewhere every
+CPU is assumed to be on package and NUMA node 0.
+*/
+struct CpuTopology
+{
+    struct Cpu
+    {
+        int id;
+        int core;     // physical core within the package
+        int package;  // socket
+        int numaNode;
+    };
+
+    std::vector<Cpu> cpus;
+
+    static CpuTopology detect();
+
+    /// CPUs local to NUMA node @p node
+    std::vector<int> cpusOfNode(int node) const;
+
+    /// NUMA node of @p cpu or -1 if unknown
+    int nodeOfCpu(int cpu) const;
+
+    /// one line per NUMA node, listing its packages, cores and CPUs
+    std::string describe() const;
+};
+
+/// parse a list like "0-3,8,10-11" as used by /sys and taskset
+std::vector<int> parseCpuList(const std::string& list);
+std::string formatCpuList(std::vector<int> cpus);
+
+/// restrict the calling thread to @p cpu. @return false if unsupported or failed.
+bool pinCurrentThread(int cpu);
+
+/**
+Allow the calling thread on all CPUs of the process again. New threads inherit the
+mask of their creator, so threads started from a pinned thread should call this.
+*/
+bool resetCurrentThreadAffinity();
+
+/// CPU the calling thread currently runs on or -1 if unknown
+int getCurrentCpu();
+
+/**
+Prefer NUMA node @p node for all future memory allocations of the calling thread,
+falling back to other nodes when it is full. Linux only.
+*/
+bool setPreferredMemoryNode(int node);
+}
+/** @} */
+/** @} */
+
+#endif /* SAMPLES_COMMON_INCLUDE_THREADAFFINITY_H_ */
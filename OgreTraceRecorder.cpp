@@ -0,0 +1,228 @@
+/*
+ * OgreTraceRecorder.cpp
+ */
+
+#include "OgreTraceRecorder.h"
+
+#include "OgreRoot.h"
+#include "OgreProfiler.h"
+#include "OgreTimer.h"
+
+#include <cstdio>
+#include <fstream>
+
+namespace Bites {
+
+namespace {
+std::atomic<uint64_t> sNextId(1);
+
+// the buffer of the current thread in the recorder with id tlsRecorderId
+thread_local uint64_t tlsRecorderId = 0;
+thread_local void* tlsBuffer = NULL;
+thread_local std::string tlsThreadName;
+
+void writeJsonString(std::ostream& out, const std::string& str)
+{
+    out << '"';
+    for (size_t i = 0; i < str.size(); ++i)
+    {
+        char c = str[i];
+        if (c == '"' || c == '\\')
+            out << '\\' << c;
+        else if ((unsigned char)c < 0x20)
+        {
+            char buf[8];
+            snprintf(buf, sizeof(buf), "\\u%04x", c);
+            out << buf;
+        }
+        else
+            out << c;
+    }
+    out << '"';
+}
+}
+
+std::atomic<TraceRecorder*> TraceRecorder::sActive(NULL);
+
+#if OGRE_PROFILING && OGRE_VERSION_MAJOR != 2
+/**
+The profiler only keeps per frame totals. A block called once per frame gets its
+exact start from ProfileInstance::currTime, blocks called several times are
+merged into one event placed after their preceding sibling.
+*/
+class TraceRecorder::ProfilerListener : public Ogre::ProfileSessionListener
+{
+public:
+    explicit ProfilerListener(TraceRecorder* recorder) : mRecorder(recorder) {}
+
+    void initializeSession() {}
+    void finializeSession() {}
+
+    void displayResults(const Ogre::ProfileInstance& instance, Ogre::ulong maxTotalFrameTime)
+    {
+        // map the microseconds of the profiler timer to our clock
+        mNow = Clock::now();
+        mTimerNow = Ogre::Root::getSingleton().getTimer()->getMicroseconds();
+        addChildren(instance, Clock::time_point());
+    }
+
+private:
+    Clock::time_point fromTimer(Ogre::ulong us) const
+    {
+        return mNow - std::chrono::microseconds(mTimerNow - us);
+    }
+
+    void addChildren(const Ogre::ProfileInstance& parent, Clock::time_point cursor)
+    {
+        Ogre::ProfileInstance::ProfileChildren::const_iterator it;
+        for (it = parent.children.begin(); it != parent.children.end(); ++it)
+        {
+            const Ogre::ProfileInstance& child = *it->second;
+            Ogre::uint calls = child.history.numCallsThisFrame;
+            if (calls == 0)
+                continue;
+
+            Clock::time_point begin = fromTimer(child.currTime);
+            if (calls > 1 && cursor != Clock::time_point())
+                begin = cursor;
+
+            Clock::time_point end = begin + std::chrono::nanoseconds(
+                int64_t(child.history.currentTimeMillisecs * 1e6));
+            mRecorder->addEvent(child.name, "ogre", begin, end,
+                                calls > 1 ? std::to_string(calls) + " calls merged" : "");
+
+            addChildren(child, begin);
+            cursor = end;
+        }
+    }
+
+    TraceRecorder* mRecorder;
+    Clock::time_point mNow;
+    Ogre::ulong mTimerNow;
+};
+#else
+class TraceRecorder::ProfilerListener {};
+#endif
+
+TraceRecorder::TraceRecorder() : mId(sNextId++), mStart(Clock::now())
+{
+}
+
+TraceRecorder::~TraceRecorder()
+{
+    deactivate();
+    detachProfiler();
+}
+
+void TraceRecorder::deactivate()
+{
+    TraceRecorder* self = this;
+    sActive.compare_exchange_strong(self, NULL);
+}
+
+void TraceRecorder::setThreadName(const std::string& name)
+{
+    tlsThreadName = name;
+}
+
+TraceRecorder::ThreadBuffer& TraceRecorder::currentThread()
+{
+    if (tlsRecorderId == mId)
+        return *static_cast<ThreadBuffer*>(tlsBuffer);
+
+    std::lock_guard<std::mutex> lock(mMutex);
+    mThreads.push_back(std::unique_ptr<ThreadBuffer>(new ThreadBuffer()));
+    ThreadBuffer* buf = mThreads.back().get();
+    buf->tid = mThreads.size();
+    buf->name = tlsThreadName.empty() ? "thread " + std::to_string(buf->tid) : tlsThreadName;
+
+    tlsRecorderId = mId;
+    tlsBuffer = buf;
+    return *buf;
+}
+
+void TraceRecorder::addEvent(const std::string& name, const char* category, Clock::time_point begin,
+                             Clock::time_point end, const std::string& detail)
+{
+    Event e;
+    e.name = name;
+    e.category = category;
+    e.detail = detail;
+    e.begin = std::chrono::duration_cast<std::chrono::nanoseconds>(begin - mStart).count();
+    e.duration = std::chrono::duration_cast<std::chrono::nanoseconds>(end - begin).count();
+
+    ThreadBuffer& buf = currentThread();
+    std::lock_guard<std::mutex> lock(buf.mutex); // only contended while writing
+    buf.events.push_back(e);
+}
+
+void TraceRecorder::attachProfiler()
+{
+#if OGRE_PROFILING && OGRE_VERSION_MAJOR != 2
+    Ogre::Profiler* prof = Ogre::Profiler::getSingletonPtr();
+    if (!prof || mProfilerListener)
+        return;
+
+    mProfilerListener.reset(new ProfilerListener(this));
+    prof->addListener(mProfilerListener.get());
+    prof->setUpdateDisplayFrequency(1); // report every frame
+    prof->setEnabled(true);
+#endif
+}
+
+void TraceRecorder::detachProfiler()
+{
+#if OGRE_PROFILING && OGRE_VERSION_MAJOR != 2
+    Ogre::Profiler* prof = Ogre::Profiler::getSingletonPtr();
+    if (prof && mProfilerListener)
+        prof->removeListener(mProfilerListener.get());
+#endif
+    mProfilerListener.reset();
+}
+
+bool TraceRecorder::write(const std::string& path) const
+{
+    std::ofstream out(path.c_str());
+    if (!out.is_open())
+        return false;
+
+    out << "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n";
+    bool first = true;
+
+    std::lock_guard<std::mutex> lock(mMutex);
+    for (size_t i = 0; i < mThreads.size(); ++i)
+    {
+        ThreadBuffer& buf = *mThreads[i];
+        std::lock_guard<std::mutex> bufLock(buf.mutex);
+
+        out << (first ? "" : ",\n") << "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":" << buf.tid
+            << ",\"args\":{\"name\":";
+        writeJsonString(out, buf.name);
+        out << "}}";
+        first = false;
+
+        char times[64];
+        for (size_t j = 0; j < buf.events.size(); ++j)
+        {
+            const Event& e = buf.events[j];
+            // microseconds with ns resolution
+            snprintf(times, sizeof(times), "\"ts\":%.3f,\"dur\":%.3f", e.begin / 1e3, e.duration / 1e3);
+
+            out << ",\n{\"name\":";
+            writeJsonString(out, e.name);
+            out << ",\"cat\":\"" << e.category << "\",\"ph\":\"X\"," << times << ",\"pid\":1,\"tid\":" << buf.tid;
+            if (!e.detail.empty())
+            {
+                out << ",\"args\":{\"detail\":";
+                writeJsonString(out, e.detail);
+                out << "}";
+            }
+            out << "}";
+        }
+    }
+    out << "\n]}\n";
+
+    return out.good();
+}
+
+}
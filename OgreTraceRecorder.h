@@ -0,0 +1,128 @@
+/*
+ * OgreTraceRecorder.h
+ *
+ * timeline of timed events from all threads, written in the Chrome trace event
+ * format that chrome://tracing and Perfetto load directly
+ */
+
+#ifndef SAMPLES_COMMON_INCLUDE_TRACERECORDER_H_
+#define SAMPLES_COMMON_INCLUDE_TRACERECORDER_H_
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+/** \addtogroup Optional
+*  @{
+*/
+/** \addtogroup Bites
+*  @{
+*/
+namespace Bites {
+
+/**
+Every thread appends to its own buffer, which is only shared with the thread
+writing the trace. Instrumented code asks for the active recorder, so nothing
+is recorded and almost nothing is spent unless a trace was requested.
+*/
+class TraceRecorder
+{
+public:
+    typedef std::chrono::steady_clock Clock;
+
+    TraceRecorder();
+    ~TraceRecorder();
+
+    /// the recorder instrumented code reports to, NULL unless tracing
+    static TraceRecorder* getActive() { return sActive.load(std::memory_order_acquire); }
+
+    /// make this the active recorder
+    void activate() { sActive.store(this, std::memory_order_release); }
+    void deactivate();
+
+    /// name of the calling thread in all traces. Can be set before any recorder exists.
+    static void setThreadName(const std::string& name);
+
+    /// add a complete event of the calling thread. @p category must be a string literal.
+    void addEvent(const std::string& name, const char* category, Clock::time_point begin,
+                  Clock::time_point end, const std::string& detail = "");
+
+    /**
+    Forward the Ogre::Profiler blocks of each frame as events of the calling thread.
+    Needs Ogre built with OGRE_PROFILING, otherwise nothing happens.
+    */
+    void attachProfiler();
+    void detachProfiler();
+
+    bool write(const std::string& path) const;
+
+private:
+    struct Event
+    {
+        std::string name;
+        const char* category;
+        std::string detail;
+        int64_t begin; // ns since the recorder was created
+        int64_t duration;
+    };
+
+    struct ThreadBuffer
+    {
+        std::mutex mutex;
+        size_t tid;
+        std::string name;
+        std::vector<Event> events;
+    };
+
+    class ProfilerListener;
+
+    ThreadBuffer& currentThread();
+
+    static std::atomic<TraceRecorder*> sActive;
+
+    uint64_t mId; // tells apart recorders that happen to reuse an address
+    Clock::time_point mStart;
+    mutable std::mutex mMutex;
+    std::vector<std::unique_ptr<ThreadBuffer> > mThreads;
+    std::unique_ptr<ProfilerListener> mProfilerListener;
+};
+
+/// records the lifetime of the scope if a recorder is active
+class TraceScope
+{
+public:
+    /// @param name and @p category must be string literals
+    TraceScope(const char* name, const char* category)
+        : mRecorder(TraceRecorder::getActive()), mName(name), mCategory(category)
+    {
+        if (mRecorder)
+            mBegin = TraceRecorder::Clock::now();
+    }
+
+    ~TraceScope()
+    {
+        if (mRecorder)
+            mRecorder->addEvent(mName, mCategory, mBegin, TraceRecorder::Clock::now(), mDetail);
+    }
+
+    bool isRecording() const { return mRecorder != NULL; }
+
+    /// shown as argument of the event. Only build it if isRecording.
+    void setDetail(const std::string& detail) { mDetail = detail; }
+
+private:
+    TraceRecorder* mRecorder;
+    const char* mName;
+    const char* mCategory;
+    std::string mDetail;
+    TraceRecorder::Clock::time_point mBegin;
+};
+}
+/** @} */
+/** @} */
+
+#endif /* SAMPLES_COMMON_INCLUDE_TRACERECORDER_H_ */
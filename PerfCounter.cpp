@@ -0,0 +1,51 @@
+/*
+ * PerfCounter.cpp
+ */
+
+#include "PerfCounter.h"
+
+#ifdef __linux__
+#include <cstring>
+#include <linux/perf_event.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+namespace Benchmark {
+
+PerfCounter::PerfCounter(Event event) : mFd(-1)
+{
+#ifdef __linux__
+    perf_event_attr attr;
+    memset(&attr, 0, sizeof(attr));
+    attr.size = sizeof(attr);
+    attr.type = PERF_TYPE_HW_CACHE;
+    uint64_t op = event == DTLB_READ_MISSES ? PERF_COUNT_HW_CACHE_OP_READ : PERF_COUNT_HW_CACHE_OP_WRITE;
+    attr.config = PERF_COUNT_HW_CACHE_DTLB | (op << 8) | (uint64_t(PERF_COUNT_HW_CACHE_RESULT_MISS) << 16);
+    attr.exclude_kernel = 1;
+    attr.exclude_hv = 1;
+    attr.inherit = 1; // reading sums up the threads started later
+
+    mFd = int(syscall(__NR_perf_event_open, &attr, 0, -1, -1, 0));
+#endif
+}
+
+PerfCounter::~PerfCounter()
+{
+#ifdef __linux__
+    if (mFd >= 0)
+        close(mFd);
+#endif
+}
+
+uint64_t PerfCounter::read() const
+{
+    uint64_t count = 0;
+#ifdef __linux__
+    if (mFd >= 0 && ::read(mFd, &count, sizeof(count)) != sizeof(count))
+        count = 0;
+#endif
+    return count;
+}
+
+}
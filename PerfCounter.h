@@ -0,0 +1,38 @@
+/*
+ * PerfCounter.h
+ *
+ * hardware event counts of the process from the Linux perf_event interface
+ */
+
+#pragma once
+
+#include <cstdint>
+
+namespace Benchmark {
+
+class PerfCounter
+{
+public:
+    enum Event
+    {
+        DTLB_READ_MISSES, // data TLB misses of loads
+        DTLB_WRITE_MISSES
+    };
+
+    /**
+     * counts @p event in the calling thread and the threads it starts afterwards, so
+     * open it before the job system for its workers to be included
+     */
+    explicit PerfCounter(Event event);
+    ~PerfCounter();
+
+    /// false if perf events are unavailable, e.g. by kernel.perf_event_paranoid or in a VM
+    bool isOpen() const { return mFd >= 0; }
+
+    /// the count so far, 0 if not open
+    uint64_t read() const;
+
+private:
+    int mFd;
+};
+}
@@ -0,0 +1,107 @@
+/*
+ * PipelinedAnimator.cpp
+ */
+
+#include "PipelinedAnimator.h"
+#include "OgreThreadAffinity.h"
+#include "OgreTraceRecorder.h"
+
+namespace Benchmark {
+
+static double msSince(PipelinedAnimator::Clock::time_point start)
+{
+    return std::chrono::duration<double, std::milli>(PipelinedAnimator::Clock::now() - start).count();
+}
+
+PipelinedAnimator::PipelinedAnimator(const std::vector<Ogre::SceneNode*>& nodes, const Ogre::Radian& rollPerFrame,
+                                     Bites::JobSystem* jobs)
+    : mNodes(nodes), mJobs(jobs), mFront(0), mPending(true), mQuit(false), mWaitTime(0), mApplyTime(0), mLatency(0)
+{
+    mRoll.FromAngleAxis(rollPerFrame, Ogre::Vector3::UNIT_Z);
+
+    mBuffers[0].reserve(nodes.size());
+    for(size_t i = 0; i < nodes.size(); ++i)
+        mBuffers[0].push_back(nodes[i]->getOrientation());
+    mBuffers[1].resize(nodes.size());
+
+    mThread = std::thread(&PipelinedAnimator::run, this);
+}
+
+PipelinedAnimator::~PipelinedAnimator()
+{
+    {
+        std::unique_lock<std::mutex> lock(mMutex);
+        mQuit = true;
+    }
+    mCond.notify_all();
+    mThread.join();
+}
+
+void PipelinedAnimator::simulate()
+{
+    Bites::TraceScope trace("simulate", "animation");
+    int back = 1 - mFront;
+    mSimStart[back] = Clock::now();
+
+    const std::vector<Ogre::Quaternion>& src = mBuffers[mFront];
+    std::vector<Ogre::Quaternion>& dst = mBuffers[back];
+    auto roll = [&](size_t begin, size_t end) {
+        for(size_t i = begin; i < end; ++i)
+            dst[i] = src[i] * mRoll; // same as SceneNode::roll in TS_LOCAL
+    };
+
+    if(mJobs && mJobs->getNumWorkers())
+        mJobs->parallel_for(0, src.size(), 0, roll);
+    else
+        roll(0, src.size());
+}
+
+void PipelinedAnimator::run()
+{
+    Bites::TraceRecorder::setThreadName("pipeline");
+    // must not share a CPU with a pinned render thread
+    Bites::resetCurrentThreadAffinity();
+
+    std::unique_lock<std::mutex> lock(mMutex);
+    while(true)
+    {
+        mCond.wait(lock, [this]() { return mPending || mQuit; });
+        if(mQuit)
+            return;
+
+        // mFront is only changed by the main thread while nothing is pending
+        lock.unlock();
+        simulate();
+        lock.lock();
+
+        mPending = false;
+        mCond.notify_all();
+    }
+}
+
+void PipelinedAnimator::applyAndKick()
+{
+    auto start = Clock::now();
+    {
+        Bites::TraceScope trace("pipeline_wait", "animation");
+        std::unique_lock<std::mutex> lock(mMutex);
+        mCond.wait(lock, [this]() { return !mPending; });
+        mWaitTime = msSince(start);
+
+        // the finished buffer becomes the front, the worker continues from it
+        mFront = 1 - mFront;
+        mPending = true;
+    }
+    mCond.notify_all();
+
+    // the worker only reads the front buffer, so we can apply it concurrently
+    Bites::TraceScope trace("apply", "animation");
+    start = Clock::now();
+    const std::vector<Ogre::Quaternion>& front = mBuffers[mFront];
+    for(size_t i = 0; i < front.size(); ++i)
+        mNodes[i]->setOrientation(front[i]);
+    mApplyTime = msSince(start);
+    mLatency = msSince(mSimStart[mFront]);
+}
+
+}
@@ -0,0 +1,70 @@
+/*
+ * PipelinedAnimator.h
+ *
+ * computes the node orientations of frame N+1 on a worker thread while frame N
+ * is rendered. The results are applied to the SceneNodes in one batch at the
+ * frame boundary.
+ */
+
+#pragma once
+
+#include <OgreSceneNode.h>
+#include "OgreJobSystem.h"
+
+#include <chrono>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+
+namespace Benchmark {
+
+class PipelinedAnimator
+{
+public:
+    typedef std::chrono::steady_clock Clock;
+
+    /**
+     * starts simulating the frame after the current orientations of @p nodes
+     * @param jobs if given, each simulation step is split across its workers
+     */
+    PipelinedAnimator(const std::vector<Ogre::SceneNode*>& nodes, const Ogre::Radian& rollPerFrame,
+                      Bites::JobSystem* jobs = NULL);
+    ~PipelinedAnimator();
+
+    /**
+     * call at the frame boundary: waits for the pending simulation step, starts the
+     * next one and applies the finished transforms to the nodes.
+     */
+    void applyAndKick();
+
+    /// ms the main thread was blocked waiting for the simulation in the last applyAndKick
+    double getWaitTime() const { return mWaitTime; }
+    /// ms spent writing the transforms to the nodes in the last applyAndKick
+    double getApplyTime() const { return mApplyTime; }
+    /// ms from the start of simulating the applied transforms until they were applied
+    double getLatency() const { return mLatency; }
+
+private:
+    void simulate();
+    void run();
+
+    const std::vector<Ogre::SceneNode*>& mNodes;
+    Ogre::Quaternion mRoll;
+    Bites::JobSystem* mJobs;
+
+    // double buffered orientations. mBuffers[mFront] was applied, the worker writes the other one.
+    std::vector<Ogre::Quaternion> mBuffers[2];
+    int mFront;
+    Clock::time_point mSimStart[2];
+
+    std::thread mThread;
+    std::mutex mMutex;
+    std::condition_variable mCond;
+    bool mPending; // a simulation step was requested and is not finished yet
+    bool mQuit;
+
+    double mWaitTime;
+    double mApplyTime;
+    double mLatency;
+};
+}
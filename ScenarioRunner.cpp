@@ -0,0 +1,101 @@
+/*
+ * ScenarioRunner.cpp
+ */
+
+#include "ScenarioRunner.h"
+
+namespace Benchmark {
+
+void ScenarioRunner::addScenario(const std::string& name, const Callback& enter, const Callback& leave)
+{
+    Scenario s = {name, enter, leave};
+    mScenarios.push_back(s);
+}
+
+const std::string& ScenarioRunner::currentScenario() const
+{
+    static const std::string none;
+    return isFinished() ? none : mScenarios[mCurrent].name;
+}
+
+void ScenarioRunner::start()
+{
+    // cartesian product of all axes, the last axis changes fastest
+    std::vector<size_t> idx(mAxes.size(), 0);
+    std::vector<size_t> prev; // of the scenario before, empty for the first
+    while(!mAxes.empty() && idx[0] < mAxes[0].size())
+    {
+        std::string name;
+        std::vector<Callback> enters;
+        for(size_t a = 0; a < mAxes.size(); ++a)
+        {
+            const Variant& v = mAxes[a][idx[a]];
+            name += (a ? "/" : "") + v.label;
+            // the scenarios run in this order, so an unchanged variant is still in effect
+            if(v.enter && (prev.empty() || prev[a] != idx[a]))
+                enters.push_back(v.enter);
+        }
+        prev = idx;
+        addScenario(name, [enters]() {
+            for(size_t i = 0; i < enters.size(); ++i)
+                enters[i]();
+        });
+
+        for(size_t a = mAxes.size(); a-- > 0;)
+        {
+            if(++idx[a] < mAxes[a].size() || a == 0)
+                break;
+            idx[a] = 0;
+        }
+    }
+    mAxes.clear();
+
+    mCurrent = 0;
+    mFrame = 0;
+    mResults.scenarios.clear();
+
+    if(isFinished())
+        return;
+
+    mResults.scenarios.push_back(ScenarioResult());
+    mResults.scenarios.back().name = mScenarios[0].name;
+    if(mScenarios[0].enter)
+        mScenarios[0].enter();
+}
+
+void ScenarioRunner::record(const std::string& metric, double value)
+{
+    if(!isMeasuring())
+        return;
+
+    mResults.scenarios.back().metrics[metric].push_back(value);
+}
+
+bool ScenarioRunner::nextFrame()
+{
+    if(isFinished())
+        return false;
+
+    ++mFrame;
+
+    if(!mMeasureFrames || mFrame < mWarmupFrames + mMeasureFrames)
+        return true;
+
+    // a copy, the callback may add scenarios and so move the one it is stored in
+    Callback leave = mScenarios[mCurrent].leave;
+    if(leave)
+        leave();
+
+    mFrame = 0;
+    if(++mCurrent >= mScenarios.size())
+        return false;
+
+    mResults.scenarios.push_back(ScenarioResult());
+    mResults.scenarios.back().name = mScenarios[mCurrent].name;
+    if(mScenarios[mCurrent].enter)
+        mScenarios[mCurrent].enter();
+
+    return true;
+}
+
+}
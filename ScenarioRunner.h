@@ -0,0 +1,91 @@
+/*
+ * ScenarioRunner.h
+ *
+ * drives a list of benchmark scenarios from the frame callbacks: each scenario
+ * is entered, warmed up and then measured for a fixed number of frames.
+ */
+
+#pragma once
+
+#include "BenchmarkResults.h"
+
+#include <functional>
+
+namespace Benchmark {
+
+class ScenarioRunner
+{
+public:
+    typedef std::function<void()> Callback;
+
+    ScenarioRunner() : mWarmupFrames(50), mMeasureFrames(0), mCurrent(0), mFrame(0) {}
+
+    /// @param measureFrames 0 means run the first scenario forever without recording
+    void setFrames(size_t warmup, size_t measure)
+    {
+        mWarmupFrames = warmup;
+        mMeasureFrames = measure;
+    }
+
+    /**
+     * @param enter called on the first frame of the scenario
+     * @param leave called after its last measured frame
+     */
+    void addScenario(const std::string& name, const Callback& enter = Callback(),
+                     const Callback& leave = Callback());
+
+    /// true while the current frame belongs to the measured part of a scenario
+    bool isMeasuring() const
+    {
+        return mMeasureFrames && mCurrent < mScenarios.size() && mFrame >= mWarmupFrames;
+    }
+
+    struct Variant
+    {
+        std::string label;
+        Callback enter;
+    };
+
+    /**
+     * add a dimension to sweep. start() adds one scenario for every combination of the
+     * variants of all axes, named by their labels joined with '/'. Entering a scenario
+     * only calls the enter callbacks of the variants that differ from the scenario before,
+     * so an axis changing slowly, e.g. one that rebuilds the scene, should be added first.
+     */
+    void addAxis(const std::vector<Variant>& variants) { mAxes.push_back(variants); }
+
+    /// enter the first scenario
+    void start();
+
+    bool isFinished() const { return mCurrent >= mScenarios.size(); }
+
+    const std::string& currentScenario() const;
+
+    /// store a sample of the current frame, ignored while warming up
+    void record(const std::string& metric, double value);
+
+    /**
+     * advance to the next frame. Calls the enter/ leave callbacks as scenarios change.
+     * @return false once all scenarios are finished
+     */
+    bool nextFrame();
+
+    RunResults& getResults() { return mResults; }
+
+private:
+    struct Scenario
+    {
+        std::string name;
+        Callback enter;
+        Callback leave;
+    };
+
+    std::vector<Scenario> mScenarios;
+    std::vector<std::vector<Variant> > mAxes;
+    RunResults mResults;
+    size_t mWarmupFrames;
+    size_t mMeasureFrames;
+    size_t mCurrent;
+    size_t mFrame;
+};
+}
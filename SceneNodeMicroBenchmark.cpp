@@ -0,0 +1,348 @@
+/*
+ * SceneNodeMicroBenchmark.cpp
+ *
+ * Google-Benchmark-style fixtures for individual scene graph operations.
+ * Every operation is timed in batches and reported as ns/op, both on a
+ * headless Root (no render system) and inside a fully initialised
+ * ApplicationContext.
+ */
+
+#include <Ogre.h>
+#include <OgreDefaultHardwareBufferManager.h>
+#include "OgreApplicationContext.h"
+
+#include <chrono>
+#include <functional>
+
+namespace {
+
+struct Fixture
+{
+    Ogre::SceneManager* scnMgr;
+    Ogre::SceneNode* parent;
+    std::vector<Ogre::SceneNode*> nodes;
+    std::vector<Ogre::MovableObject*> objects;
+    Ogre::Vector3 sink;
+};
+
+/// one benchmarked operation. Only run() is timed, everything else prepares or cleans up.
+struct MicroBenchmark
+{
+    const char* name;
+    std::function<void(Fixture&, size_t count)> setUp;    // once, before the first batch
+    std::function<void(Fixture&, size_t count)> preBatch; // before every batch
+    std::function<void(Fixture&, size_t count)> run;      // the timed operations
+    std::function<void(Fixture&, size_t count)> postBatch;// after every batch
+};
+
+struct Options
+{
+    bool headless = true;
+    bool renderSystem = true;
+    Ogre::String filter;
+    double minTime = 0.5; // seconds of timed work per benchmark
+    size_t batchSize = 1024;
+};
+
+Ogre::Entity* createCube(Ogre::SceneManager* scnMgr)
+{
+    return scnMgr->createEntity("Cube_d.mesh");
+}
+
+void createNodes(Fixture& f, size_t count, bool withCubes)
+{
+    for(size_t i = 0; i < count; ++i)
+    {
+        Ogre::SceneNode* n = f.parent->createChildSceneNode();
+        n->setPosition(Ogre::Vector3(0.5f * (i % 140), 0.0f, 0.5f * (i / 140)));
+        if(withCubes)
+            n->attachObject(createCube(f.scnMgr));
+        f.nodes.push_back(n);
+    }
+}
+
+void destroyNodes(Fixture& f, size_t)
+{
+    f.parent->removeAndDestroyAllChildren();
+    for(auto o : f.objects)
+        f.scnMgr->destroyMovableObject(o);
+    f.objects.clear();
+    f.scnMgr->destroyAllEntities();
+    f.nodes.clear();
+}
+
+void destroyChild(Ogre::SceneNode* parent, Ogre::SceneNode* child)
+{
+#if OGRE_VERSION_MAJOR == 2 || OGRE_VERSION >= ((1 << 16) | (11 << 8))
+    parent->removeAndDestroyChild(child);
+#else
+    parent->removeAndDestroyChild(child->getName());
+#endif
+}
+
+std::vector<MicroBenchmark> registerBenchmarks()
+{
+    using namespace Ogre;
+    std::vector<MicroBenchmark> b;
+
+    b.push_back({"createChildSceneNode", nullptr, nullptr,
+        [](Fixture& f, size_t count) {
+            for(size_t i = 0; i < count; ++i)
+                f.nodes.push_back(f.parent->createChildSceneNode());
+        },
+        destroyNodes});
+
+    b.push_back({"attachObject",
+        nullptr,
+        [](Fixture& f, size_t count) {
+            createNodes(f, count, false);
+            for(size_t i = 0; i < count; ++i)
+                f.objects.push_back(createCube(f.scnMgr));
+        },
+        [](Fixture& f, size_t count) {
+            for(size_t i = 0; i < count; ++i)
+                f.nodes[i]->attachObject(f.objects[i]);
+        },
+        [](Fixture& f, size_t count) {
+            f.objects.clear(); // now owned by the nodes, destroyed with all entities
+            destroyNodes(f, count);
+        }});
+
+    b.push_back({"setPosition",
+        [](Fixture& f, size_t count) { createNodes(f, count, false); },
+        nullptr,
+        [](Fixture& f, size_t count) {
+            for(size_t i = 0; i < count; ++i)
+                f.nodes[i]->setPosition(Real(i), 0, Real(count - i));
+        },
+        nullptr});
+
+    b.push_back({"roll",
+        [](Fixture& f, size_t count) { createNodes(f, count, false); },
+        nullptr,
+        [](Fixture& f, size_t count) {
+            for(size_t i = 0; i < count; ++i)
+                f.nodes[i]->roll(Radian(0.08));
+        },
+        nullptr});
+
+    b.push_back({"yaw",
+        [](Fixture& f, size_t count) { createNodes(f, count, false); },
+        nullptr,
+        [](Fixture& f, size_t count) {
+            for(size_t i = 0; i < count; ++i)
+                f.nodes[i]->yaw(Radian(0.08));
+        },
+        nullptr});
+
+    b.push_back({"pitch",
+        [](Fixture& f, size_t count) { createNodes(f, count, false); },
+        nullptr,
+        [](Fixture& f, size_t count) {
+            for(size_t i = 0; i < count; ++i)
+                f.nodes[i]->pitch(Radian(0.08));
+        },
+        nullptr});
+
+    b.push_back({"lookAt/TS_PARENT",
+        [](Fixture& f, size_t count) {
+            createNodes(f, count, false);
+            for(auto n : f.nodes)
+                n->translate(0, 1, 0); // never look at our own position
+        },
+        nullptr,
+        [](Fixture& f, size_t count) {
+            for(size_t i = 0; i < count; ++i)
+                f.nodes[i]->lookAt(Vector3(0, 0, 0), Node::TS_PARENT);
+        },
+        nullptr});
+
+    b.push_back({"_getDerivedPosition/clean",
+        [](Fixture& f, size_t count) { createNodes(f, count, false); },
+        [](Fixture& f, size_t count) {
+            for(size_t i = 0; i < count; ++i)
+                f.nodes[i]->_getDerivedPosition();
+        },
+        [](Fixture& f, size_t count) {
+            for(size_t i = 0; i < count; ++i)
+                f.sink += f.nodes[i]->_getDerivedPosition();
+        },
+        nullptr});
+
+    b.push_back({"_getDerivedPosition/dirty",
+        [](Fixture& f, size_t count) { createNodes(f, count, false); },
+        [](Fixture& f, size_t count) {
+            for(size_t i = 0; i < count; ++i)
+                f.nodes[i]->translate(0, 0.001f, 0);
+        },
+        [](Fixture& f, size_t count) {
+            for(size_t i = 0; i < count; ++i)
+                f.sink += f.nodes[i]->_getDerivedPosition();
+        },
+        nullptr});
+
+    b.push_back({"removeAndDestroyChild",
+        nullptr,
+        [](Fixture& f, size_t count) { createNodes(f, count, false); },
+        [](Fixture& f, size_t count) {
+            for(size_t i = count; i > 0; --i)
+                destroyChild(f.parent, f.nodes[i - 1]);
+        },
+        [](Fixture& f, size_t) { f.nodes.clear(); }});
+
+#if OGRE_VERSION_MAJOR != 2
+    b.push_back({"_updateBounds",
+        [](Fixture& f, size_t count) {
+            createNodes(f, count, true);
+            f.parent->_update(true, false);
+        },
+        nullptr,
+        [](Fixture& f, size_t count) {
+            for(size_t i = 0; i < count; ++i)
+                f.nodes[i]->_updateBounds();
+        },
+        nullptr});
+#endif
+
+    return b;
+}
+
+void runBenchmarks(Ogre::SceneManager* scnMgr, const Options& opts, const char* mode)
+{
+    typedef std::chrono::steady_clock Clock;
+
+    printf("%-32s %12s %12s  %s\n", "Benchmark", "Time", "Iterations", "Mode");
+    printf("--------------------------------------------------------------------------\n");
+
+    std::vector<MicroBenchmark> benchmarks = registerBenchmarks();
+    for(auto& b : benchmarks)
+    {
+        if(!opts.filter.empty() && Ogre::String(b.name).find(opts.filter) == Ogre::String::npos)
+            continue;
+
+        Fixture f;
+        f.scnMgr = scnMgr;
+        f.parent = scnMgr->getRootSceneNode()->createChildSceneNode();
+        f.sink = Ogre::Vector3::ZERO;
+
+        if(b.setUp)
+            b.setUp(f, opts.batchSize);
+
+        size_t iterations = 0;
+        Clock::duration timed(0);
+        while(std::chrono::duration<double>(timed).count() < opts.minTime)
+        {
+            if(b.preBatch)
+                b.preBatch(f, opts.batchSize);
+
+            auto start = Clock::now();
+            b.run(f, opts.batchSize);
+            timed += Clock::now() - start;
+            iterations += opts.batchSize;
+
+            if(b.postBatch)
+                b.postBatch(f, opts.batchSize);
+        }
+
+        destroyNodes(f, opts.batchSize);
+        destroyChild(scnMgr->getRootSceneNode(), f.parent);
+
+        double ns = std::chrono::duration<double, std::nano>(timed).count() / iterations;
+        printf("%-32s %9.1f ns %12zu  %s\n", b.name, ns, iterations, mode);
+    }
+    printf("\n");
+}
+
+Ogre::SceneManager* createSceneManager(Ogre::Root* root)
+{
+#if OGRE_VERSION_MAJOR == 2
+    return root->createSceneManager(Ogre::ST_GENERIC, 1, Ogre::INSTANCING_CULLING_SINGLETHREAD);
+#else
+    return root->createSceneManager(Ogre::ST_GENERIC);
+#endif
+}
+
+//! [headless]
+void runHeadless(const Options& opts)
+{
+    using namespace Ogre;
+
+    // no plugins, no render system. Meshes go to system memory buffers.
+    Root* root = OGRE_NEW Root("", "", "SceneNodeMicroBenchmark.log");
+    DefaultHardwareBufferManager* bufferMgr = OGRE_NEW DefaultHardwareBufferManager();
+
+    ResourceGroupManager::getSingleton().addResourceLocation(".", "FileSystem", RGN_DEFAULT);
+    ResourceGroupManager::getSingleton().initialiseAllResourceGroups();
+
+    SceneManager* scnMgr = createSceneManager(root);
+    runBenchmarks(scnMgr, opts, "headless");
+    root->destroySceneManager(scnMgr);
+
+    OGRE_DELETE bufferMgr;
+    OGRE_DELETE root;
+}
+//! [headless]
+
+//! [rendersystem]
+class MicroBenchmarkApp : public Bites::ApplicationContext
+{
+public:
+    explicit MicroBenchmarkApp(const Options& opts)
+        : Bites::ApplicationContext("SceneNodeMicroBenchmark"), mOpts(opts) {}
+
+    void setupInput(bool grab) {}
+
+    void setup()
+    {
+        Bites::ApplicationContext::setup();
+
+        Ogre::SceneManager* scnMgr = createSceneManager(getRoot());
+        Ogre::RTShader::ShaderGenerator::getSingletonPtr()->addSceneManager(scnMgr);
+        runBenchmarks(scnMgr, mOpts, getRoot()->getRenderSystem()->getName().c_str());
+        getRoot()->destroySceneManager(scnMgr);
+    }
+
+private:
+    Options mOpts;
+};
+//! [rendersystem]
+
+}
+
+//! [main]
+int main(int argc, char *argv[])
+{
+    Options opts;
+
+    for(int i = 1; i < argc; ++i)
+    {
+        Ogre::String arg = argv[i];
+        if(arg == "--headless")
+            opts.renderSystem = false;
+        else if(arg == "--rendersystem")
+            opts.headless = false;
+        else if(arg.find("--filter=") == 0)
+            opts.filter = arg.substr(9);
+        else if(arg.find("--min-time=") == 0)
+            opts.minTime = atof(arg.c_str() + 11);
+        else if(arg.find("--batch=") == 0)
+            opts.batchSize = std::max(1, atoi(arg.c_str() + 8));
+        else
+        {
+            printf("usage: %s [--headless|--rendersystem] [--filter=name] [--min-time=sec] [--batch=ops]\n", argv[0]);
+            return 1;
+        }
+    }
+
+    if(opts.headless)
+        runHeadless(opts);
+
+    if(opts.renderSystem)
+    {
+        MicroBenchmarkApp app(opts);
+        app.initApp();
+        app.closeApp();
+    }
+    return 0;
+}
+//! [main]
@@ -0,0 +1,401 @@
+/*
+ * SceneQueryBenchmark.cpp
+ */
+
+#include "SceneQueryBenchmark.h"
+
+#include <algorithm>
+#include <chrono>
+#include <limits>
+
+namespace Benchmark {
+
+static const uint32_t LEAF_SIZE = 4;
+
+ObjectBvh::Box ObjectBvh::worldBox(const Ogre::MovableObject* obj)
+{
+    const Ogre::AxisAlignedBox& aabb = obj->getWorldBoundingBox(true);
+
+    Box b;
+    if(aabb.isFinite())
+    {
+        b.min = aabb.getMinimum();
+        b.max = aabb.getMaximum();
+    }
+    else if(aabb.isInfinite())
+    {
+        b.min = Ogre::Vector3(-std::numeric_limits<Ogre::Real>::max());
+        b.max = Ogre::Vector3(std::numeric_limits<Ogre::Real>::max());
+    }
+    else
+    {
+        // null boxes never intersect anything
+        b.min = Ogre::Vector3(std::numeric_limits<Ogre::Real>::max());
+        b.max = Ogre::Vector3(-std::numeric_limits<Ogre::Real>::max());
+    }
+    return b;
+}
+
+void ObjectBvh::build(const std::vector<Ogre::MovableObject*>& objects)
+{
+    mObjects = objects;
+    mObjectBoxes.clear();
+    mNodes.clear();
+    mNodes.reserve(2 * objects.size() / LEAF_SIZE + 1);
+
+    std::vector<Ogre::Vector3> centroids;
+    centroids.reserve(objects.size());
+    for(size_t i = 0; i < objects.size(); ++i)
+    {
+        mObjectBoxes.push_back(worldBox(objects[i]));
+        centroids.push_back((mObjectBoxes[i].min + mObjectBoxes[i].max) * 0.5f);
+    }
+
+    if(!objects.empty())
+        buildRecursive(0, uint32_t(objects.size()), centroids);
+    mChanged.assign(mNodes.size(), 0);
+}
+
+uint32_t ObjectBvh::buildRecursive(uint32_t first, uint32_t count, std::vector<Ogre::Vector3>& centroids)
+{
+    uint32_t idx = uint32_t(mNodes.size());
+    mNodes.push_back(Node());
+
+    Box box = mObjectBoxes[first];
+    Box centroidBox = {centroids[first], centroids[first]};
+    for(uint32_t i = first + 1; i < first + count; ++i)
+    {
+        box.merge(mObjectBoxes[i]);
+        centroidBox.min.makeFloor(centroids[i]);
+        centroidBox.max.makeCeil(centroids[i]);
+    }
+    mNodes[idx].box = box;
+
+    if(count <= LEAF_SIZE)
+    {
+        mNodes[idx].first = first;
+        mNodes[idx].count = count;
+        return idx;
+    }
+
+    Ogre::Vector3 extent = centroidBox.max - centroidBox.min;
+    int axis = extent.x > extent.y ? (extent.x > extent.z ? 0 : 2) : (extent.y > extent.z ? 1 : 2);
+
+    // sort objects, their boxes and centroids together by the centroid on the split axis
+    std::vector<uint32_t> order(count);
+    for(uint32_t i = 0; i < count; ++i)
+        order[i] = first + i;
+    uint32_t half = count / 2;
+    std::nth_element(order.begin(), order.begin() + half, order.end(),
+                     [&centroids, axis](uint32_t a, uint32_t b) { return centroids[a][axis] < centroids[b][axis]; });
+
+    std::vector<Ogre::MovableObject*> objects(count);
+    std::vector<Box> boxes(count);
+    std::vector<Ogre::Vector3> cents(count);
+    for(uint32_t i = 0; i < count; ++i)
+    {
+        objects[i] = mObjects[order[i]];
+        boxes[i] = mObjectBoxes[order[i]];
+        cents[i] = centroids[order[i]];
+    }
+    std::copy(objects.begin(), objects.end(), mObjects.begin() + first);
+    std::copy(boxes.begin(), boxes.end(), mObjectBoxes.begin() + first);
+    std::copy(cents.begin(), cents.end(), centroids.begin() + first);
+
+    buildRecursive(first, half, centroids);
+    uint32_t right = buildRecursive(first + half, count - half, centroids);
+
+    mNodes[idx].first = right;
+    mNodes[idx].count = 0;
+    return idx;
+}
+
+size_t ObjectBvh::refit()
+{
+    size_t changedInner = 0;
+
+    // children come after their parents
+    for(size_t i = mNodes.size(); i-- > 0;)
+    {
+        Node& n = mNodes[i];
+        Box box;
+        if(n.count)
+        {
+            for(uint32_t j = n.first; j < n.first + n.count; ++j)
+                mObjectBoxes[j] = worldBox(mObjects[j]);
+
+            box = mObjectBoxes[n.first];
+            for(uint32_t j = n.first + 1; j < n.first + n.count; ++j)
+                box.merge(mObjectBoxes[j]);
+        }
+        else
+        {
+            if(!mChanged[i + 1] && !mChanged[n.first])
+            {
+                mChanged[i] = 0;
+                continue;
+            }
+            box = mNodes[i + 1].box;
+            box.merge(mNodes[n.first].box);
+        }
+
+        mChanged[i] = box != n.box;
+        if(mChanged[i])
+        {
+            n.box = box;
+            changedInner += n.count == 0;
+        }
+    }
+
+    return changedInner;
+}
+
+Ogre::AxisAlignedBox ObjectBvh::getBounds() const
+{
+    if(mNodes.empty())
+        return Ogre::AxisAlignedBox::BOX_NULL;
+    return Ogre::AxisAlignedBox(mNodes[0].box.min, mNodes[0].box.max);
+}
+
+void ObjectBvh::rayQuery(const Ogre::Ray& ray, std::vector<RayHit>& result) const
+{
+    const Ogre::Vector3& o = ray.getOrigin();
+    const Ogre::Vector3& d = ray.getDirection();
+    Ogre::Vector3 invDir(1 / d.x, 1 / d.y, 1 / d.z);
+
+    // slab test, the distance is 0 if the ray starts inside like Ogre::Ray::intersects
+    auto intersect = [&](const Box& b, Ogre::Real& dist) {
+        Ogre::Real tmin = 0, tmax = std::numeric_limits<Ogre::Real>::max();
+        for(int a = 0; a < 3; ++a)
+        {
+            Ogre::Real t0 = (b.min[a] - o[a]) * invDir[a];
+            Ogre::Real t1 = (b.max[a] - o[a]) * invDir[a];
+            if(t0 > t1)
+                std::swap(t0, t1);
+            tmin = std::max(tmin, t0);
+            tmax = std::min(tmax, t1);
+            if(tmin > tmax)
+                return false;
+        }
+        dist = tmin;
+        return true;
+    };
+
+    result.clear();
+    if(mNodes.empty())
+        return;
+
+    uint32_t stack[64];
+    int top = 0;
+    stack[top++] = 0;
+    while(top)
+    {
+        uint32_t i = stack[--top];
+        const Node& n = mNodes[i];
+        Ogre::Real dist;
+        if(!intersect(n.box, dist))
+            continue;
+
+        if(n.count)
+        {
+            for(uint32_t j = n.first; j < n.first + n.count; ++j)
+            {
+                if(intersect(mObjectBoxes[j], dist))
+                    result.push_back(RayHit(dist, mObjects[j]));
+            }
+            continue;
+        }
+        stack[top++] = n.first;
+        stack[top++] = i + 1;
+    }
+
+    std::sort(result.begin(), result.end(),
+              [](const RayHit& a, const RayHit& b) { return a.first < b.first; });
+}
+
+void ObjectBvh::sphereQuery(const Ogre::Sphere& sphere, std::vector<Ogre::MovableObject*>& result) const
+{
+    const Ogre::Vector3& c = sphere.getCenter();
+    Ogre::Real r2 = sphere.getRadius() * sphere.getRadius();
+
+    auto intersect = [&](const Box& b) {
+        Ogre::Real d2 = 0;
+        for(int a = 0; a < 3; ++a)
+        {
+            Ogre::Real v = std::max(b.min[a] - c[a], std::max(Ogre::Real(0), c[a] - b.max[a]));
+            d2 += v * v;
+        }
+        return d2 <= r2;
+    };
+
+    result.clear();
+    if(mNodes.empty())
+        return;
+
+    uint32_t stack[64];
+    int top = 0;
+    stack[top++] = 0;
+    while(top)
+    {
+        uint32_t i = stack[--top];
+        const Node& n = mNodes[i];
+        if(!intersect(n.box))
+            continue;
+
+        if(n.count)
+        {
+            for(uint32_t j = n.first; j < n.first + n.count; ++j)
+            {
+                if(intersect(mObjectBoxes[j]))
+                    result.push_back(mObjects[j]);
+            }
+            continue;
+        }
+        stack[top++] = n.first;
+        stack[top++] = i + 1;
+    }
+}
+
+void ObjectBvh::boxQuery(const Ogre::AxisAlignedBox& box, std::vector<Ogre::MovableObject*>& result) const
+{
+    const Ogre::Vector3& qmin = box.getMinimum();
+    const Ogre::Vector3& qmax = box.getMaximum();
+
+    auto intersect = [&](const Box& b) {
+        return b.min.x <= qmax.x && b.max.x >= qmin.x && b.min.y <= qmax.y && b.max.y >= qmin.y &&
+               b.min.z <= qmax.z && b.max.z >= qmin.z;
+    };
+
+    result.clear();
+    if(mNodes.empty())
+        return;
+
+    uint32_t stack[64];
+    int top = 0;
+    stack[top++] = 0;
+    while(top)
+    {
+        uint32_t i = stack[--top];
+        const Node& n = mNodes[i];
+        if(!intersect(n.box))
+            continue;
+
+        if(n.count)
+        {
+            for(uint32_t j = n.first; j < n.first + n.count; ++j)
+            {
+                if(intersect(mObjectBoxes[j]))
+                    result.push_back(mObjects[j]);
+            }
+            continue;
+        }
+        stack[top++] = n.first;
+        stack[top++] = i + 1;
+    }
+}
+
+SceneQueryBenchmark::SceneQueryBenchmark(Ogre::SceneManager* scnMgr, const std::vector<Ogre::SceneNode*>& nodes)
+    : mSceneMgr(scnMgr), mRandom(42)
+{
+    std::vector<Ogre::MovableObject*> objects;
+    for(size_t i = 0; i < nodes.size(); ++i)
+    {
+        for(unsigned short j = 0; j < nodes[i]->numAttachedObjects(); ++j)
+            objects.push_back(nodes[i]->getAttachedObject(j));
+    }
+    mBvh.build(objects);
+
+    mRayQuery = scnMgr->createRayQuery(Ogre::Ray());
+    mRayQuery->setSortByDistance(true);
+    mSphereQuery = scnMgr->createSphereQuery(Ogre::Sphere());
+    mBoxQuery = scnMgr->createAABBQuery(Ogre::AxisAlignedBox());
+
+    // only the grid, not the light
+    mRayQuery->setQueryTypeMask(Ogre::SceneManager::ENTITY_TYPE_MASK);
+    mSphereQuery->setQueryTypeMask(Ogre::SceneManager::ENTITY_TYPE_MASK);
+    mBoxQuery->setQueryTypeMask(Ogre::SceneManager::ENTITY_TYPE_MASK);
+}
+
+SceneQueryBenchmark::~SceneQueryBenchmark()
+{
+    mSceneMgr->destroyQuery(mRayQuery);
+    mSceneMgr->destroyQuery(mSphereQuery);
+    mSceneMgr->destroyQuery(mBoxQuery);
+}
+
+SceneQueryBenchmark::Times SceneQueryBenchmark::run(size_t count, const Ogre::Vector3& eye)
+{
+    typedef std::chrono::steady_clock Clock;
+    auto msSince = [](Clock::time_point start) {
+        return std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+    };
+
+    const Ogre::Real radius = 1.0f;
+    const Ogre::Vector3 halfSize(0.75f);
+
+    // the bounds of the last frame are good enough to place the queries
+    Ogre::AxisAlignedBox bounds = mBvh.getBounds();
+    std::uniform_real_distribution<Ogre::Real> x(bounds.getMinimum().x, bounds.getMaximum().x);
+    std::uniform_real_distribution<Ogre::Real> z(bounds.getMinimum().z, bounds.getMaximum().z);
+    std::vector<Ogre::Vector3> targets(count);
+    for(size_t i = 0; i < count; ++i)
+        targets[i] = Ogre::Vector3(x(mRandom), bounds.getCenter().y, z(mRandom));
+
+    Times t = {};
+
+    auto start = Clock::now();
+    for(size_t i = 0; i < count; ++i)
+    {
+        mRayQuery->setRay(Ogre::Ray(eye, (targets[i] - eye).normalisedCopy()));
+        t.sceneHits += mRayQuery->execute().size();
+    }
+    t.sceneRay = msSince(start);
+
+    start = Clock::now();
+    for(size_t i = 0; i < count; ++i)
+    {
+        mSphereQuery->setSphere(Ogre::Sphere(targets[i], radius));
+        t.sceneHits += mSphereQuery->execute().movables.size();
+    }
+    t.sceneSphere = msSince(start);
+
+    start = Clock::now();
+    for(size_t i = 0; i < count; ++i)
+    {
+        mBoxQuery->setBox(Ogre::AxisAlignedBox(targets[i] - halfSize, targets[i] + halfSize));
+        t.sceneHits += mBoxQuery->execute().movables.size();
+    }
+    t.sceneBox = msSince(start);
+
+    start = Clock::now();
+    mBvh.refit();
+    t.refit = msSince(start);
+
+    start = Clock::now();
+    for(size_t i = 0; i < count; ++i)
+    {
+        mBvh.rayQuery(Ogre::Ray(eye, (targets[i] - eye).normalisedCopy()), mRayHits);
+        t.bvhHits += mRayHits.size();
+    }
+    t.bvhRay = msSince(start);
+
+    start = Clock::now();
+    for(size_t i = 0; i < count; ++i)
+    {
+        mBvh.sphereQuery(Ogre::Sphere(targets[i], radius), mHits);
+        t.bvhHits += mHits.size();
+    }
+    t.bvhSphere = msSince(start);
+
+    start = Clock::now();
+    for(size_t i = 0; i < count; ++i)
+    {
+        mBvh.boxQuery(Ogre::AxisAlignedBox(targets[i] - halfSize, targets[i] + halfSize), mHits);
+        t.bvhHits += mHits.size();
+    }
+    t.bvhBox = msSince(start);
+
+    return t;
+}
+
+}
@@ -0,0 +1,102 @@
+/*
+ * SceneQueryBenchmark.h
+ *
+ * ray, sphere and box queries against the grid, answered by the SceneManager and
+ * by a bounding volume hierarchy over the object world AABBs.
+ */
+
+#pragma once
+
+#include <Ogre.h>
+
+#include <random>
+
+namespace Benchmark {
+
+/// BVH over the world AABBs of a fixed set of objects
+class ObjectBvh
+{
+public:
+    /// top down build, splitting at the median centroid of the longest axis
+    void build(const std::vector<Ogre::MovableObject*>& objects);
+
+    /**
+     * update the boxes after objects moved, keeping the tree topology. Subtrees
+     * whose boxes did not change are not touched above their leaves.
+     * @return number of inner nodes whose box changed
+     */
+    size_t refit();
+
+    typedef std::pair<Ogre::Real, Ogre::MovableObject*> RayHit;
+
+    /// all objects whose box the ray hits, sorted by distance
+    void rayQuery(const Ogre::Ray& ray, std::vector<RayHit>& result) const;
+    void sphereQuery(const Ogre::Sphere& sphere, std::vector<Ogre::MovableObject*>& result) const;
+    void boxQuery(const Ogre::AxisAlignedBox& box, std::vector<Ogre::MovableObject*>& result) const;
+
+    Ogre::AxisAlignedBox getBounds() const;
+
+private:
+    struct Box
+    {
+        Ogre::Vector3 min;
+        Ogre::Vector3 max;
+
+        void merge(const Box& o)
+        {
+            min.makeFloor(o.min);
+            max.makeCeil(o.max);
+        }
+        bool operator!=(const Box& o) const { return min != o.min || max != o.max; }
+    };
+
+    // depth first order: the left child directly follows its parent
+    struct Node
+    {
+        Box box;
+        uint32_t first; // leaf: first object, inner: index of the right child
+        uint32_t count; // objects of a leaf, 0 for inner nodes
+    };
+
+    static Box worldBox(const Ogre::MovableObject* obj);
+    uint32_t buildRecursive(uint32_t first, uint32_t count, std::vector<Ogre::Vector3>& centroids);
+
+    std::vector<Node> mNodes;
+    std::vector<Ogre::MovableObject*> mObjects;
+    std::vector<Box> mObjectBoxes; // world boxes as of the last build or refit
+    std::vector<char> mChanged;
+};
+
+class SceneQueryBenchmark
+{
+public:
+    SceneQueryBenchmark(Ogre::SceneManager* scnMgr, const std::vector<Ogre::SceneNode*>& nodes);
+    ~SceneQueryBenchmark();
+
+    /// all times in ms, hits summed over the queries of one kind
+    struct Times
+    {
+        double sceneRay, sceneSphere, sceneBox;
+        double refit, bvhRay, bvhSphere, bvhBox;
+        size_t sceneHits, bvhHits;
+    };
+
+    /**
+     * fire @p count queries of every kind at random places of the grid, first through
+     * the SceneManager, then through the refitted BVH
+     * @param eye origin of the rays
+     */
+    Times run(size_t count, const Ogre::Vector3& eye);
+
+private:
+    Ogre::SceneManager* mSceneMgr;
+    Ogre::RaySceneQuery* mRayQuery;
+    Ogre::SphereSceneQuery* mSphereQuery;
+    Ogre::AxisAlignedBoxSceneQuery* mBoxQuery;
+
+    ObjectBvh mBvh;
+    std::mt19937 mRandom; // fixed seed, so every run fires the same queries
+    std::vector<ObjectBvh::RayHit> mRayHits;
+    std::vector<Ogre::MovableObject*> mHits;
+};
+}
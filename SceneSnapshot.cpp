@@ -0,0 +1,377 @@
+/*
+ * SceneSnapshot.cpp
+ */
+
+#include "SceneSnapshot.h"
+
+#include <algorithm>
+#include <fstream>
+#include <functional>
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace Benchmark {
+
+void SceneSnapshotWriter::addInstanceManager(const Ogre::String& name, const Ogre::String& mesh,
+                                             Ogre::InstanceManager::InstancingTechnique technique,
+                                             uint32_t instancesPerBatch)
+{
+    Snapshot::InstanceManager im = {addString(name), addString(mesh), uint32_t(technique), instancesPerBatch};
+    mInstanceManagers.push_back(im);
+}
+
+uint32_t SceneSnapshotWriter::addString(const Ogre::String& str)
+{
+    std::map<Ogre::String, uint32_t>::iterator it = mStringOffsets.find(str);
+    if(it != mStringOffsets.end())
+        return it->second;
+
+    uint32_t offset = uint32_t(mStrings.size());
+    mStrings.insert(mStrings.end(), str.begin(), str.end());
+    mStrings.push_back(0);
+    mStringOffsets[str] = offset;
+    return offset;
+}
+
+void SceneSnapshotWriter::addNode(Ogre::SceneNode* node, uint32_t parent)
+{
+    using namespace Ogre;
+
+    Snapshot::Node n;
+    n.parent = parent;
+    n.firstObject = uint32_t(mObjects.size());
+    n.numObjects = 0;
+
+    const Vector3& p = node->getPosition();
+    const Quaternion& q = node->getOrientation();
+    const Vector3& s = node->getScale();
+    float pos[3] = {float(p.x), float(p.y), float(p.z)};
+    float rot[4] = {float(q.w), float(q.x), float(q.y), float(q.z)};
+    float scale[3] = {float(s.x), float(s.y), float(s.z)};
+    std::copy(pos, pos + 3, n.position);
+    std::copy(rot, rot + 4, n.orientation);
+    std::copy(scale, scale + 3, n.scale);
+
+    for(unsigned short i = 0; i < node->numAttachedObjects(); ++i)
+    {
+        MovableObject* mo = node->getAttachedObject(i);
+        Snapshot::Object o = {Snapshot::NONE, Snapshot::NONE, Snapshot::NONE};
+
+        if(Entity* ent = dynamic_cast<Entity*>(mo))
+        {
+            o.mesh = addString(ent->getMesh()->getName());
+            const String& mat = ent->getSubEntity(0)->getMaterialName();
+            if(mat != ent->getMesh()->getSubMesh(0)->getMaterialName())
+                o.material = addString(mat);
+        }
+        else if(InstancedEntity* ient = dynamic_cast<InstancedEntity*>(mo))
+        {
+            InstanceBatch* batch = ient->_getOwner();
+            o.mesh = addString(batch->_getMeshRef()->getName());
+            o.material = addString(batch->getMaterial()->getName());
+
+            for(size_t j = 0; j < mInstanceManagers.size(); ++j)
+            {
+                if(mInstanceManagers[j].mesh == o.mesh)
+                    o.instanceManager = uint32_t(j);
+            }
+            if(o.instanceManager == Snapshot::NONE)
+                continue; // unknown manager
+        }
+        else
+        {
+            continue; // only meshes are supported
+        }
+
+        mObjects.push_back(o);
+        n.numObjects++;
+    }
+
+    uint32_t idx = uint32_t(mNodes.size());
+    mNodes.push_back(n);
+
+    for(unsigned short i = 0; i < node->numChildren(); ++i)
+        addNode(static_cast<SceneNode*>(node->getChild(i)), idx);
+}
+
+bool SceneSnapshotWriter::write(const Ogre::String& path) const
+{
+    std::ofstream out(path.c_str(), std::ios::binary);
+    if(!out.is_open())
+        return false;
+
+    Snapshot::Header h;
+    std::copy(Snapshot::MAGIC, Snapshot::MAGIC + sizeof(h.magic), h.magic);
+    h.numNodes = uint32_t(mNodes.size());
+    h.numObjects = uint32_t(mObjects.size());
+    h.numInstanceManagers = uint32_t(mInstanceManagers.size());
+    h.stringTableSize = uint32_t(mStrings.size());
+
+    out.write((const char*)&h, sizeof(h));
+    if(!mNodes.empty())
+        out.write((const char*)&mNodes[0], mNodes.size() * sizeof(Snapshot::Node));
+    if(!mObjects.empty())
+        out.write((const char*)&mObjects[0], mObjects.size() * sizeof(Snapshot::Object));
+    if(!mInstanceManagers.empty())
+        out.write((const char*)&mInstanceManagers[0], mInstanceManagers.size() * sizeof(Snapshot::InstanceManager));
+    if(!mStrings.empty())
+        out.write(&mStrings[0], mStrings.size());
+
+    return out.good();
+}
+
+bool SceneSnapshotWriter::writeDotScene(const Ogre::String& path) const
+{
+    std::ofstream out(path.c_str());
+    if(!out.is_open())
+        return false;
+
+    // the DotScene format nests the nodes, so emit them depth first
+    std::vector<std::vector<uint32_t> > children(mNodes.size() + 1);
+    for(uint32_t i = 0; i < mNodes.size(); ++i)
+        children[mNodes[i].parent == Snapshot::NONE ? mNodes.size() : mNodes[i].parent].push_back(i);
+
+    std::function<void(uint32_t, int)> writeNode = [&](uint32_t idx, int depth) {
+        const Snapshot::Node& n = mNodes[idx];
+        Ogre::String indent(2 * depth, ' ');
+
+        out << indent << "<node name=\"snapshot" << idx << "\">\n";
+        out << indent << "  <position x=\"" << n.position[0] << "\" y=\"" << n.position[1] << "\" z=\""
+            << n.position[2] << "\"/>\n";
+        out << indent << "  <rotation qw=\"" << n.orientation[0] << "\" qx=\"" << n.orientation[1]
+            << "\" qy=\"" << n.orientation[2] << "\" qz=\"" << n.orientation[3] << "\"/>\n";
+        out << indent << "  <scale x=\"" << n.scale[0] << "\" y=\"" << n.scale[1] << "\" z=\"" << n.scale[2]
+            << "\"/>\n";
+
+        for(uint32_t i = n.firstObject; i < n.firstObject + n.numObjects; ++i)
+        {
+            const Snapshot::Object& o = mObjects[i];
+            out << indent << "  <entity name=\"snapshot" << idx << "_" << i - n.firstObject << "\" meshFile=\""
+                << &mStrings[o.mesh] << "\"";
+            if(o.material != Snapshot::NONE)
+                out << " material=\"" << &mStrings[o.material] << "\"";
+            out << "/>\n";
+        }
+
+        for(uint32_t c : children[idx])
+            writeNode(c, depth + 1);
+        out << indent << "</node>\n";
+    };
+
+    out << "<scene formatVersion=\"1.1\">\n  <nodes>\n";
+    for(uint32_t c : children.back())
+        writeNode(c, 2);
+    out << "  </nodes>\n</scene>\n";
+
+    return out.good();
+}
+
+SceneSnapshot::SceneSnapshot()
+    : mMapping(NULL), mSize(0), mHeader(NULL), mNodes(NULL), mObjects(NULL), mInstanceManagers(NULL), mStrings(NULL)
+{
+#ifdef _WIN32
+    mFile = mMapHandle = NULL;
+#endif
+}
+
+SceneSnapshot::~SceneSnapshot()
+{
+    close();
+}
+
+bool SceneSnapshot::open(const Ogre::String& path)
+{
+    close();
+
+#ifdef _WIN32
+    mFile = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ, NULL, OPEN_EXISTING,
+                        FILE_FLAG_SEQUENTIAL_SCAN, NULL);
+    if(mFile == INVALID_HANDLE_VALUE)
+    {
+        mFile = NULL;
+        return false;
+    }
+    LARGE_INTEGER size;
+    GetFileSizeEx(mFile, &size);
+    mSize = size_t(size.QuadPart);
+    mMapHandle = CreateFileMapping(mFile, NULL, PAGE_READONLY, 0, 0, NULL);
+    mMapping = mMapHandle ? MapViewOfFile(mMapHandle, FILE_MAP_READ, 0, 0, 0) : NULL;
+#else
+    int fd = ::open(path.c_str(), O_RDONLY);
+    if(fd < 0)
+        return false;
+
+    struct stat st;
+    if(fstat(fd, &st) == 0 && st.st_size > 0)
+    {
+        mSize = size_t(st.st_size);
+        mMapping = mmap(NULL, mSize, PROT_READ, MAP_PRIVATE, fd, 0);
+        if(mMapping == MAP_FAILED)
+            mMapping = NULL;
+        else
+            madvise(mMapping, mSize, MADV_SEQUENTIAL);
+    }
+    ::close(fd); // the mapping stays valid
+#endif
+
+    if(!mMapping || mSize < sizeof(Snapshot::Header))
+    {
+        close();
+        return false;
+    }
+
+    const char* data = static_cast<const char*>(mMapping);
+    mHeader = reinterpret_cast<const Snapshot::Header*>(data);
+
+    // 64 bit, so huge counts cannot wrap around to the file size
+    uint64_t expected = sizeof(Snapshot::Header) + uint64_t(mHeader->numNodes) * sizeof(Snapshot::Node) +
+                        uint64_t(mHeader->numObjects) * sizeof(Snapshot::Object) +
+                        uint64_t(mHeader->numInstanceManagers) * sizeof(Snapshot::InstanceManager) +
+                        mHeader->stringTableSize;
+    if(!std::equal(Snapshot::MAGIC, Snapshot::MAGIC + sizeof(Snapshot::MAGIC), mHeader->magic) ||
+       expected != mSize)
+    {
+        close();
+        return false;
+    }
+
+    data += sizeof(Snapshot::Header);
+    mNodes = reinterpret_cast<const Snapshot::Node*>(data);
+    data += mHeader->numNodes * sizeof(Snapshot::Node);
+    mObjects = reinterpret_cast<const Snapshot::Object*>(data);
+    data += mHeader->numObjects * sizeof(Snapshot::Object);
+    mInstanceManagers = reinterpret_cast<const Snapshot::InstanceManager*>(data);
+    data += mHeader->numInstanceManagers * sizeof(Snapshot::InstanceManager);
+    mStrings = data;
+
+    if(!validate())
+    {
+        close();
+        return false;
+    }
+    return true;
+}
+
+bool SceneSnapshot::validate() const
+{
+    // so every offset into the table ends inside of it
+    if(mHeader->stringTableSize && mStrings[mHeader->stringTableSize - 1] != 0)
+        return false;
+
+    for(uint32_t i = 0; i < mHeader->numInstanceManagers; ++i)
+    {
+        const Snapshot::InstanceManager& im = mInstanceManagers[i];
+        if(!isString(im.name) || !isString(im.mesh))
+            return false;
+    }
+
+    for(uint32_t i = 0; i < mHeader->numObjects; ++i)
+    {
+        const Snapshot::Object& o = mObjects[i];
+        if(!isString(o.mesh) || (o.material != Snapshot::NONE && !isString(o.material)))
+            return false;
+        // instanced entities are created by their material
+        if(o.instanceManager != Snapshot::NONE &&
+           (o.instanceManager >= mHeader->numInstanceManagers || o.material == Snapshot::NONE))
+            return false;
+    }
+
+    for(uint32_t i = 0; i < mHeader->numNodes; ++i)
+    {
+        const Snapshot::Node& n = mNodes[i];
+        if(n.parent != Snapshot::NONE && n.parent >= i) // parents first
+            return false;
+        if(uint64_t(n.firstObject) + n.numObjects > mHeader->numObjects)
+            return false;
+    }
+    return true;
+}
+
+void SceneSnapshot::close()
+{
+    if(mMapping)
+    {
+#ifdef _WIN32
+        UnmapViewOfFile(mMapping);
+#else
+        munmap(mMapping, mSize);
+#endif
+    }
+#ifdef _WIN32
+    if(mMapHandle)
+        CloseHandle(mMapHandle);
+    if(mFile)
+        CloseHandle(mFile);
+    mFile = mMapHandle = NULL;
+#endif
+
+    mMapping = NULL;
+    mSize = 0;
+    mHeader = NULL;
+}
+
+void SceneSnapshot::instantiate(Ogre::SceneManager* scnMgr, Ogre::SceneNode* parent,
+                                std::vector<Ogre::SceneNode*>& createdNodes,
+                                std::vector<Ogre::SceneNode*>& objectNodes) const
+{
+    using namespace Ogre;
+
+    if(!mHeader)
+        return;
+
+    std::vector<InstanceManager*> managers(mHeader->numInstanceManagers);
+    for(size_t i = 0; i < managers.size(); ++i)
+    {
+        const Snapshot::InstanceManager& im = mInstanceManagers[i];
+        if(scnMgr->hasInstanceManager(string(im.name)))
+            managers[i] = scnMgr->getInstanceManager(string(im.name));
+        else
+            managers[i] = scnMgr->createInstanceManager(
+                string(im.name), string(im.mesh), RGN_DEFAULT,
+                InstanceManager::InstancingTechnique(im.technique), im.instancesPerBatch);
+    }
+
+    size_t base = createdNodes.size();
+    createdNodes.reserve(base + mHeader->numNodes);
+    objectNodes.reserve(objectNodes.size() + mHeader->numNodes);
+
+    for(uint32_t i = 0; i < mHeader->numNodes; ++i)
+    {
+        const Snapshot::Node& n = mNodes[i];
+        SceneNode* p = n.parent == Snapshot::NONE ? parent : createdNodes[base + n.parent];
+
+        SceneNode* sn = p->createChildSceneNode(
+            Vector3(n.position[0], n.position[1], n.position[2]),
+            Quaternion(n.orientation[0], n.orientation[1], n.orientation[2], n.orientation[3]));
+        if(n.scale[0] != 1 || n.scale[1] != 1 || n.scale[2] != 1)
+            sn->setScale(n.scale[0], n.scale[1], n.scale[2]);
+
+        for(uint32_t j = n.firstObject; j < n.firstObject + n.numObjects; ++j)
+        {
+            const Snapshot::Object& o = mObjects[j];
+            if(o.instanceManager != Snapshot::NONE)
+            {
+                sn->attachObject(managers[o.instanceManager]->createInstancedEntity(string(o.material)));
+                continue;
+            }
+
+            Entity* ent = scnMgr->createEntity(string(o.mesh));
+            if(o.material != Snapshot::NONE)
+                ent->setMaterialName(string(o.material));
+            sn->attachObject(ent);
+        }
+
+        createdNodes.push_back(sn);
+        if(n.numObjects)
+            objectNodes.push_back(sn);
+    }
+}
+
+}
@@ -0,0 +1,132 @@
+/*
+ * SceneSnapshot.h
+ *
+ * compact binary snapshot of a scene graph, loaded by memory mapping the file
+ * and building all nodes and objects in one pass.
+ */
+
+#pragma once
+
+#include <Ogre.h>
+
+#include <stdint.h>
+
+namespace Benchmark {
+
+/**
+ * File layout, the structs below as they are in memory, so in the native byte order
+ * and 4 byte aligned:
+ * Header, Node[numNodes], Object[numObjects], InstanceManager[numInstanceManagers], strings
+ *
+ * Nodes are stored parents first. Strings are referenced by their offset into the
+ * zero terminated string table.
+ */
+namespace Snapshot
+{
+    static const char MAGIC[8] = {'O', 'G', 'R', 'E', 'S', 'N', 'P', '1'};
+    static const uint32_t NONE = 0xFFFFFFFF;
+
+    struct Header
+    {
+        char magic[8];
+        uint32_t numNodes;
+        uint32_t numObjects;
+        uint32_t numInstanceManagers;
+        uint32_t stringTableSize;
+    };
+
+    struct Node
+    {
+        uint32_t parent; // index into the nodes or NONE for the root of the loaded scene
+        uint32_t firstObject;
+        uint32_t numObjects;
+        float position[3];
+        float orientation[4]; // w, x, y, z
+        float scale[3];
+    };
+
+    struct Object
+    {
+        uint32_t mesh;            // string
+        uint32_t material;        // string, NONE keeps the material of the mesh
+        uint32_t instanceManager; // index or NONE for a plain Entity
+    };
+
+    struct InstanceManager
+    {
+        uint32_t name;  // string
+        uint32_t mesh;  // string
+        uint32_t technique; // Ogre::InstanceManager::InstancingTechnique
+        uint32_t instancesPerBatch;
+    };
+}
+
+/// collects scene nodes and writes them as snapshot or as DotScene XML
+class SceneSnapshotWriter
+{
+public:
+    /// makes InstancedEntities created by this manager from @p mesh recognisable
+    void addInstanceManager(const Ogre::String& name, const Ogre::String& mesh,
+                            Ogre::InstanceManager::InstancingTechnique technique, uint32_t instancesPerBatch);
+
+    /// add @p node with all its children below @p parent (NONE for the scene root)
+    void addNode(Ogre::SceneNode* node, uint32_t parent = Snapshot::NONE);
+
+    bool write(const Ogre::String& path) const;
+
+    /// same content for Ogre's DotScene importer. Instancing info is dropped.
+    bool writeDotScene(const Ogre::String& path) const;
+
+private:
+    uint32_t addString(const Ogre::String& str);
+
+    std::vector<Snapshot::Node> mNodes;
+    std::vector<Snapshot::Object> mObjects;
+    std::vector<Snapshot::InstanceManager> mInstanceManagers;
+    std::vector<char> mStrings;
+    std::map<Ogre::String, uint32_t> mStringOffsets;
+};
+
+/// a memory mapped snapshot file
+class SceneSnapshot
+{
+public:
+    SceneSnapshot();
+    ~SceneSnapshot();
+
+    bool open(const Ogre::String& path);
+    void close();
+
+    /**
+     * create all nodes and objects of the snapshot
+     * @param parent receives the top level nodes
+     * @param createdNodes receives all created nodes, parents first
+     * @param objectNodes receives the nodes that have objects attached
+     */
+    void instantiate(Ogre::SceneManager* scnMgr, Ogre::SceneNode* parent,
+                     std::vector<Ogre::SceneNode*>& createdNodes,
+                     std::vector<Ogre::SceneNode*>& objectNodes) const;
+
+    size_t getNumNodes() const { return mHeader ? mHeader->numNodes : 0; }
+
+private:
+    const char* string(uint32_t offset) const { return mStrings + offset; }
+    bool isString(uint32_t offset) const { return offset < mHeader->stringTableSize; }
+
+    /// every index and offset points into the mapping
+    bool validate() const;
+
+    void* mMapping;
+    size_t mSize;
+#ifdef _WIN32
+    void* mFile;
+    void* mMapHandle;
+#endif
+
+    const Snapshot::Header* mHeader;
+    const Snapshot::Node* mNodes;
+    const Snapshot::Object* mObjects;
+    const Snapshot::InstanceManager* mInstanceManagers;
+    const char* mStrings;
+};
+}
@@ -0,0 +1,225 @@
+/*
+ * SoaAnimator.cpp
+ */
+
+#include "SoaAnimator.h"
+#include "OgreTraceRecorder.h"
+
+#if defined(__AVX__) || defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <immintrin.h>
+#endif
+
+#include <cmath>
+
+namespace Benchmark {
+
+namespace {
+const float BOB_AMPLITUDE = 0.1f;
+
+// the kernels are written once against these, the scalar version handles the remainders
+struct ScalarLanes
+{
+    typedef float V;
+    static const size_t WIDTH = 1;
+    static V load(const float* p) { return *p; }
+    static void store(float* p, V v) { *p = v; }
+    static V set1(float f) { return f; }
+    static V add(V a, V b) { return a + b; }
+    static V sub(V a, V b) { return a - b; }
+    static V mul(V a, V b) { return a * b; }
+};
+
+#if defined(__AVX__)
+struct VectorLanes
+{
+    typedef __m256 V;
+    static const size_t WIDTH = 8;
+    static V load(const float* p) { return _mm256_loadu_ps(p); }
+    static void store(float* p, V v) { _mm256_storeu_ps(p, v); }
+    static V set1(float f) { return _mm256_set1_ps(f); }
+    static V add(V a, V b) { return _mm256_add_ps(a, b); }
+    static V sub(V a, V b) { return _mm256_sub_ps(a, b); }
+    static V mul(V a, V b) { return _mm256_mul_ps(a, b); }
+};
+const char* INSTRUCTION_SET = "AVX";
+#elif defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+struct VectorLanes
+{
+    typedef __m128 V;
+    static const size_t WIDTH = 4;
+    static V load(const float* p) { return _mm_loadu_ps(p); }
+    static void store(float* p, V v) { _mm_storeu_ps(p, v); }
+    static V set1(float f) { return _mm_set1_ps(f); }
+    static V add(V a, V b) { return _mm_add_ps(a, b); }
+    static V sub(V a, V b) { return _mm_sub_ps(a, b); }
+    static V mul(V a, V b) { return _mm_mul_ps(a, b); }
+};
+const char* INSTRUCTION_SET = "SSE2";
+#else
+typedef ScalarLanes VectorLanes;
+const char* INSTRUCTION_SET = "scalar";
+#endif
+}
+
+const char* SoaAnimator::getInstructionSet()
+{
+    return INSTRUCTION_SET;
+}
+
+bool SoaAnimator::parseMotion(const std::string& name, Motion& motion)
+{
+    static const char* names[] = {"roll", "orbit", "bob"};
+    for(int i = 0; i < 3; ++i)
+    {
+        if(name == names[i])
+        {
+            motion = Motion(i);
+            return true;
+        }
+    }
+    return false;
+}
+
+SoaAnimator::SoaAnimator(const std::vector<Ogre::SceneNode*>& nodes, Motion motion, float step,
+                         Bites::JobSystem* jobs)
+    : mNodes(nodes), mMotion(motion), mStep(step), mJobs(jobs), mFrame(0)
+{
+    size_t n = nodes.size();
+    mPosX.resize(n), mPosY.resize(n), mPosZ.resize(n);
+    mRotW.resize(n), mRotX.resize(n), mRotY.resize(n), mRotZ.resize(n);
+
+    for(size_t i = 0; i < n; ++i)
+    {
+        const Ogre::Vector3& p = nodes[i]->getPosition();
+        const Ogre::Quaternion& q = nodes[i]->getOrientation();
+        mPosX[i] = p.x, mPosY[i] = p.y, mPosZ[i] = p.z;
+        mRotW[i] = q.w, mRotX[i] = q.x, mRotY[i] = q.y, mRotZ[i] = q.z;
+    }
+
+    if(motion != BOB)
+        return;
+
+    mBase.resize(n), mSin.resize(n), mCos.resize(n);
+    for(size_t i = 0; i < n; ++i)
+    {
+        float phase = 0.5f * (mPosX[i] + mPosZ[i]);
+        mSin[i] = std::sin(phase);
+        mCos[i] = std::cos(phase);
+        mBase[i] = mPosY[i] - BOB_AMPLITUDE * mSin[i];
+    }
+}
+
+template <class L, SoaAnimator::Motion M> void SoaAnimator::kernel(size_t begin, size_t end)
+{
+    typedef typename L::V V;
+
+    if(M == ROLL)
+    {
+        // q * (cos(a/2), 0, 0, sin(a/2)), with the zero terms of Quaternion::operator* dropped
+        V c = L::set1(std::cos(0.5f * mStep)), s = L::set1(std::sin(0.5f * mStep));
+        for(size_t i = begin; i < end; i += L::WIDTH)
+        {
+            V w = L::load(&mRotW[i]), x = L::load(&mRotX[i]), y = L::load(&mRotY[i]), z = L::load(&mRotZ[i]);
+            L::store(&mRotW[i], L::sub(L::mul(w, c), L::mul(z, s)));
+            L::store(&mRotX[i], L::add(L::mul(x, c), L::mul(y, s)));
+            L::store(&mRotY[i], L::sub(L::mul(y, c), L::mul(x, s)));
+            L::store(&mRotZ[i], L::add(L::mul(z, c), L::mul(w, s)));
+        }
+    }
+    else if(M == ORBIT)
+    {
+        V c = L::set1(std::cos(mStep)), s = L::set1(std::sin(mStep));
+        for(size_t i = begin; i < end; i += L::WIDTH)
+        {
+            V x = L::load(&mPosX[i]), z = L::load(&mPosZ[i]);
+            L::store(&mPosX[i], L::add(L::mul(x, c), L::mul(z, s)));
+            L::store(&mPosZ[i], L::sub(L::mul(z, c), L::mul(x, s)));
+        }
+    }
+    else
+    {
+        // advance the phase by the angle sum identities, so no sine is evaluated per node
+        V c = L::set1(std::cos(mStep)), s = L::set1(std::sin(mStep)), a = L::set1(BOB_AMPLITUDE);
+        for(size_t i = begin; i < end; i += L::WIDTH)
+        {
+            V ps = L::load(&mSin[i]), pc = L::load(&mCos[i]);
+            V ns = L::add(L::mul(ps, c), L::mul(pc, s));
+            L::store(&mSin[i], ns);
+            L::store(&mCos[i], L::sub(L::mul(pc, c), L::mul(ps, s)));
+            L::store(&mPosY[i], L::add(L::load(&mBase[i]), L::mul(a, ns)));
+        }
+    }
+}
+
+template <SoaAnimator::Motion M> void SoaAnimator::run(size_t begin, size_t end)
+{
+    size_t vectorEnd = end - (end - begin) % VectorLanes::WIDTH;
+    kernel<VectorLanes, M>(begin, vectorEnd);
+    kernel<ScalarLanes, M>(vectorEnd, end);
+}
+
+void SoaAnimator::update()
+{
+    Bites::TraceScope trace("soa_update", "animation");
+
+    std::function<void(size_t, size_t)> fn;
+    switch(mMotion)
+    {
+    case ROLL:
+        fn = [this](size_t b, size_t e) { run<ROLL>(b, e); };
+        break;
+    case ORBIT:
+        fn = [this](size_t b, size_t e) { run<ORBIT>(b, e); };
+        break;
+    case BOB:
+        fn = [this](size_t b, size_t e) { run<BOB>(b, e); };
+        break;
+    }
+
+    if(mJobs && mJobs->getNumWorkers())
+        mJobs->parallel_for(0, mNodes.size(), 0, fn);
+    else
+        fn(0, mNodes.size());
+}
+
+void SoaAnimator::apply()
+{
+    Bites::TraceScope trace("soa_apply", "animation");
+
+    if(mMotion == ROLL)
+    {
+        for(size_t i = 0; i < mNodes.size(); ++i)
+            mNodes[i]->setOrientation(mRotW[i], mRotX[i], mRotY[i], mRotZ[i]);
+    }
+    else
+    {
+        for(size_t i = 0; i < mNodes.size(); ++i)
+            mNodes[i]->setPosition(mPosX[i], mPosY[i], mPosZ[i]);
+    }
+}
+
+void SoaAnimator::updateNodes()
+{
+    Ogre::Quaternion orbit(Ogre::Radian(mStep), Ogre::Vector3::UNIT_Y);
+    for(size_t i = 0; i < mNodes.size(); ++i)
+    {
+        Ogre::SceneNode* n = mNodes[i];
+        if(mMotion == ROLL)
+        {
+            n->roll(Ogre::Radian(mStep));
+        }
+        else if(mMotion == ORBIT)
+        {
+            n->setPosition(orbit * n->getPosition());
+        }
+        else
+        {
+            const Ogre::Vector3& p = n->getPosition();
+            float phase = 0.5f * (p.x + p.z) + mFrame * mStep;
+            n->translate(0, BOB_AMPLITUDE * (std::sin(phase + mStep) - std::sin(phase)), 0);
+        }
+    }
+    ++mFrame;
+}
+
+}
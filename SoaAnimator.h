@@ -0,0 +1,67 @@
+/*
+ * SoaAnimator.h
+ *
+ * keeps the transforms of the animated nodes in contiguous arrays, one per
+ * component, updates them with SIMD kernels and writes them to the nodes in one pass
+ */
+
+#pragma once
+
+#include <OgreSceneNode.h>
+#include "OgreJobSystem.h"
+
+namespace Benchmark {
+
+class SoaAnimator
+{
+public:
+    enum Motion
+    {
+        ROLL,  // constant rotation around the local z axis, like SceneNode::roll
+        ORBIT, // constant rotation of the position around the parent y axis
+        BOB    // vertical sine wave, phase shifted by the position
+    };
+
+    /// widest vector instruction set the kernels were compiled for
+    static const char* getInstructionSet();
+
+    static bool parseMotion(const std::string& name, Motion& motion);
+
+    /**
+     * takes the current transforms of @p nodes, and a copy of the list, so later
+     * changes to @p nodes do not affect the animator
+     * @param step radians per frame
+     * @param jobs if given, the kernels are split across its workers
+     */
+    SoaAnimator(const std::vector<Ogre::SceneNode*>& nodes, Motion motion, float step, Bites::JobSystem* jobs = NULL);
+
+    /// advance the arrays by one frame
+    void update();
+
+    /// write the components the motion changes to the nodes
+    void apply();
+
+    /// advance the nodes by one frame through the SceneNode interface, the reference for update and apply
+    void updateNodes();
+
+    Motion getMotion() const { return mMotion; }
+
+private:
+    template <class Lanes, Motion M> void kernel(size_t begin, size_t end);
+    template <Motion M> void run(size_t begin, size_t end);
+
+    std::vector<Ogre::SceneNode*> mNodes;
+    Motion mMotion;
+    float mStep;
+    Bites::JobSystem* mJobs;
+
+    // the transforms, no motion changes the scale
+    std::vector<float> mPosX, mPosY, mPosZ;
+    std::vector<float> mRotW, mRotX, mRotY, mRotZ;
+
+    // BOB: rest height and the sine and cosine of the current phase
+    std::vector<float> mBase, mSin, mCos;
+
+    size_t mFrame; // of updateNodes
+};
+}
@@ -0,0 +1,105 @@
+/*
+ * ViewportTimer.h
+ *
+ * times the update of every viewport and the visible object search within it
+ */
+
+#pragma once
+
+#include <OgreRenderTargetListener.h>
+#include <OgreSceneManager.h>
+#include <OgreViewport.h>
+
+#include <chrono>
+#include <vector>
+
+namespace Benchmark {
+
+/**
+ * Viewport::update renders the scene through its camera: the scene graph update,
+ * which the scene manager does only for the first camera of a frame, the visible object
+ * search and the render queue. The search is bracketed by the scene manager listener,
+ * the rest of the update is queue sorting and draw submission.
+ *
+ * Add it as listener of every render target and of the scene manager. Searches of
+ * nested updates, e.g. shadow textures, count for the viewport being updated.
+ */
+class ViewportTimer : public Ogre::RenderTargetListener, public Ogre::SceneManager::Listener
+{
+public:
+    typedef std::chrono::steady_clock Clock;
+
+    struct Entry
+    {
+        Ogre::Viewport* viewport;
+        double update; // ms in Viewport::update
+        double cull;   // ms of it finding visible objects
+        size_t searches;
+    };
+
+    ViewportTimer() : mCurrent(-1) {}
+
+    void preViewportUpdate(const Ogre::RenderTargetViewportEvent& evt)
+    {
+        mCurrent = int(find(evt.source));
+        mUpdateStart = Clock::now();
+    }
+
+    void postViewportUpdate(const Ogre::RenderTargetViewportEvent& evt)
+    {
+        mEntries[mCurrent].update += msSince(mUpdateStart);
+        mCurrent = -1;
+    }
+
+    void preFindVisibleObjects(Ogre::SceneManager*, Ogre::SceneManager::IlluminationRenderStage, Ogre::Viewport*)
+    {
+        mCullStart = Clock::now();
+    }
+
+    void postFindVisibleObjects(Ogre::SceneManager*, Ogre::SceneManager::IlluminationRenderStage, Ogre::Viewport* vp)
+    {
+        Entry& e = mEntries[mCurrent >= 0 ? size_t(mCurrent) : find(vp)];
+        e.cull += msSince(mCullStart);
+        ++e.searches;
+    }
+
+    /// the viewports in the order they were first updated, with their times since the last nextFrame
+    const std::vector<Entry>& getEntries() const { return mEntries; }
+
+    void nextFrame()
+    {
+        for(auto& e : mEntries)
+        {
+            e.update = 0;
+            e.cull = 0;
+            e.searches = 0;
+        }
+    }
+
+    /// forget all viewports, e.g. after some were destroyed
+    void clear() { mEntries.clear(); }
+
+private:
+    static double msSince(Clock::time_point start)
+    {
+        return std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+    }
+
+    size_t find(Ogre::Viewport* vp)
+    {
+        for(size_t i = 0; i < mEntries.size(); ++i)
+        {
+            if(mEntries[i].viewport == vp)
+                return i;
+        }
+        Entry e = {vp, 0, 0, 0};
+        mEntries.push_back(e);
+        return mEntries.size() - 1;
+    }
+
+    std::vector<Entry> mEntries;
+    int mCurrent; // entry being updated, -1 outside of Viewport::update
+    Clock::time_point mUpdateStart;
+    Clock::time_point mCullStart;
+};
+}
@@ -0,0 +1,99 @@
+/*
+ * VisibilityTracker.h
+ *
+ * counts the objects that survive node culling each frame and remembers the
+ * last frame every tracked object was visible in
+ */
+
+#pragma once
+
+#include <OgreMovableObject.h>
+
+#include <deque>
+#include <limits>
+
+namespace Benchmark {
+
+/**
+ * SceneManager calls MovableObject::Listener::objectRendering for every object of a
+ * node inside the camera frustum, once per camera. Every object gets its own small
+ * listener that knows its index, so recording needs no lookup.
+ */
+class VisibilityTracker
+{
+public:
+    static const size_t NEVER = std::numeric_limits<size_t>::max();
+
+    VisibilityTracker() : mLightListener(NULL), mFrame(0), mCount(0), mLastCount(0) {}
+
+    /// light queries of the tracked objects go to @p listener, NULL for the default path
+    void setLightQueryListener(Ogre::MovableObject::Listener* listener) { mLightListener = listener; }
+
+    /// replaces any listener set on @p obj. @return index of the object in this tracker
+    size_t track(Ogre::MovableObject* obj)
+    {
+        mListeners.push_back(ObjectListener(this, mLastVisible.size()));
+        mLastVisible.push_back(size_t(NEVER));
+        obj->setListener(&mListeners.back());
+        return mListeners.back().index;
+    }
+
+    /// forget all objects, e.g. after they were destroyed
+    void clear()
+    {
+        mListeners.clear();
+        mLastVisible.clear();
+    }
+
+    /// call once per frame after rendering
+    void nextFrame()
+    {
+        mLastCount = mCount;
+        mCount = 0;
+        ++mFrame;
+    }
+
+    /// objects rendered by the last finished frame
+    size_t getVisibleCount() const { return mLastCount; }
+
+    /// whether object @p index passed culling in the frame that is being rendered
+    bool isVisibleThisFrame(size_t index) const { return mLastVisible[index] == mFrame; }
+
+    size_t getLastVisibleFrame(size_t index) const { return mLastVisible[index]; }
+    size_t getFrame() const { return mFrame; }
+
+private:
+    struct ObjectListener : public Ogre::MovableObject::Listener
+    {
+        ObjectListener(VisibilityTracker* t, size_t i) : tracker(t), index(i) {}
+
+        bool objectRendering(const Ogre::MovableObject*, const Ogre::Camera*)
+        {
+            tracker->mLastVisible[index] = tracker->mFrame;
+            ++tracker->mCount;
+            return true;
+        }
+
+        const Ogre::LightList* objectQueryLights(const Ogre::MovableObject* obj)
+        {
+            return tracker->mLightListener ? tracker->mLightListener->objectQueryLights(obj) : NULL;
+        }
+
+        void objectMoved(Ogre::MovableObject* obj)
+        {
+            if(tracker->mLightListener)
+                tracker->mLightListener->objectMoved(obj);
+        }
+
+        VisibilityTracker* tracker;
+        size_t index;
+    };
+
+    std::deque<ObjectListener> mListeners; // stable addresses
+    std::vector<size_t> mLastVisible;
+    Ogre::MovableObject::Listener* mLightListener;
+    size_t mFrame;
+    size_t mCount;
+    size_t mLastCount;
+};
+}
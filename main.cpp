@@ -1,8 +1,43 @@
 #include <Ogre.h>
 #include "OgreApplicationContext.h"
+#include "OgreThreadAffinity.h"
 #include <OgreProfiler.h>
 #include <OgreOverlaySystem.h>
 
+#include "BenchmarkResults.h"
+#include "ScenarioRunner.h"
+#include "PipelinedAnimator.h"
+#include "SoaAnimator.h"
+#include "SceneSnapshot.h"
+#include "BulkSceneBuilder.h"
+#include "LiveMetrics.h"
+#include "MultiSceneBenchmark.h"
+#include "SceneQueryBenchmark.h"
+#include "VisibilityTracker.h"
+#include "LightQueryTimer.h"
+#include "MeshLod.h"
+#include "CullingTimer.h"
+#include "ViewportTimer.h"
+#include "ListenerOverhead.h"
+#include "ArenaAllocator.h"
+#include "PerfCounter.h"
+#include "Autotuner.h"
+
+#include <algorithm>
+#include <cmath>
+#include <chrono>
+#include <iterator>
+#include <map>
+#include <memory>
+#include <random>
+#include <sstream>
+#include <cstring>
+
+#ifdef __linux__
+#include <time.h>
+#include <unistd.h>
+#endif
+
 #if OGRE_VERSION_MAJOR == 2
 #include <OgreFrameStats.h>
 #include <Compositor/OgreCompositorManager2.h>
@@ -10,7 +45,42 @@
 
 #if OGRE_VERSION_MAJOR > 2
 #include <OgreDeprecated.h>
+#include <OgreSceneLoaderManager.h>
+#endif
+
+typedef std::chrono::steady_clock Clock;
+
+static double msSince(Clock::time_point start)
+{
+    return std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+}
+
+/// ms since the process was started, including the dynamic linking before main. -1 if unknown.
+static double msSinceExec()
+{
+#ifdef __linux__
+    // field 22 of /proc/self/stat, in clock ticks after boot, i.e. with a resolution of 10 ms
+    FILE* f = fopen("/proc/self/stat", "r");
+    if(!f)
+        return -1;
+    char buf[1024];
+    size_t n = fread(buf, 1, sizeof(buf) - 1, f);
+    fclose(f);
+    buf[n] = 0;
+
+    const char* p = strrchr(buf, ')'); // the command name may contain spaces
+    unsigned long long start = 0;
+    if(!p || sscanf(p + 2, "%*c %*d %*d %*d %*d %*d %*u %*u %*u %*u %*u %*u %*u %*d %*d %*d %*d %*d %*d %llu",
+                    &start) != 1)
+        return -1;
+
+    timespec now;
+    clock_gettime(CLOCK_BOOTTIME, &now);
+    return (now.tv_sec + now.tv_nsec * 1e-9) * 1000 - start * 1000.0 / sysconf(_SC_CLK_TCK);
+#else
+    return -1;
 #endif
+}
 
 class MyTestApp : public Bites::ApplicationContext, public Bites::InputListener
 {
@@ -21,20 +91,187 @@ public:
 
     void setupInput(bool grab) {}
 
+    void setCameraPosition(int i);
+    void setPipelined(bool enable);
+    void setLazyAnimation(bool enable);
+    void setSoaAnimation(bool enable);
+    size_t animateVisible();
+
+    void buildScene();
+    Ogre::Vector3 gridPosition(int i, int j) const;
+    size_t clusterOf(int i, int j) const;
+    void createClusters();
+    size_t countCullingTests() const;
+    void createGrid();
+    void createGridBulk();
+    void destroyGrid();
+    void rebuildGrid(int size);
+    void setupAutotune();
+    void benchmarkConstruction(int repetitions);
+    void trackVisibility();
+    void trackLightQueries();
+    void setLightCount(size_t count);
+    void setCharacterCount(size_t count);
+    void setCameraCount(size_t count);
+    void placeExtraCameras();
+    void recordViewports();
+    void setListeners(bool overlay, bool input, size_t count);
+    void renewArena();
+    void setArena(bool enable, bool hugePages);
+    void setSoftwareSkinning(bool enable);
+    void updateCharacters(Ogre::Real timeStep);
+    void moveLights();
+    void setMeshLod(bool enable);
+    void recordLodSelection();
+    void benchmarkMultiScene();
+    void publishFrame();
+    void saveSnapshot(const std::string& path);
+    bool loadSnapshot(const std::string& path);
+    bool loadDotScene(const std::string& path);
+
+    bool frameStarted(const Ogre::FrameEvent& evt) {
+        Bites::ApplicationContext::frameStarted(evt);
+
+        if(quiet_frames)
+            setLogSuppressed(runner.isMeasuring());
+
+        if(move_lights)
+            moveLights();
+        updateCharacters(evt.timeSinceLastFrame);
+
+        if(animator) {
+            animator->applyAndKick();
+            runner.record("pipeline_wait", live.pipelineWait = animator->getWaitTime());
+            runner.record("animate", live.animate = animator->getApplyTime());
+            runner.record("latency", live.latency = animator->getLatency());
+        } else if(rotate_cubes && animateStart != Clock::time_point()) {
+            // the transforms computed last frame are rendered now
+            runner.record("latency", live.latency = msSince(animateStart));
+        }
+
+        if(queryBench) {
+            auto t = queryBench->run(queries, camNode->_getDerivedPosition());
+            runner.record("query_ray", t.sceneRay);
+            runner.record("query_sphere", t.sceneSphere);
+            runner.record("query_box", t.sceneBox);
+            runner.record("query_hits", t.sceneHits);
+            runner.record("bvh_refit", t.refit);
+            runner.record("bvh_ray", t.bvhRay);
+            runner.record("bvh_sphere", t.bvhSphere);
+            runner.record("bvh_box", t.bvhBox);
+            runner.record("bvh_hits", t.bvhHits);
+        }
+
+        if(tlbMisses)
+            tlbFrameStart = tlbMisses->read();
+        frameStart = Clock::now();
+        return true;
+    }
+
     bool frameRenderingQueued(const Ogre::FrameEvent& evt) {
-        Bites::ApplicationContext::frameRenderingQueued(evt);
+        // scene graph update, culling and draw submission of all render targets
+        runner.record("render", live.render = msSince(frameStart));
 
-        if(!rotate_cubes)
-            return true;
+        if(tlbMisses)
+            runner.record("dtlb_render", double(tlbMisses->read() - tlbFrameStart));
+
+        auto dispatchStart = Clock::now();
+        Bites::ApplicationContext::frameRenderingQueued(evt);
+        if(sweep_listeners)
+            runner.record("input_dispatch", msSince(dispatchStart));
 
-        for(auto& n : nodes) {
-            n->roll(Ogre::Radian(0.08));
+        if(rotate_cubes && !animator) {
+            Bites::TraceScope trace("animate", "animation");
+            animateStart = Clock::now();
+            if(tlbMisses)
+                tlbAnimateStart = tlbMisses->read();
+            size_t animated = nodes.size();
+            if(lazy_animation) {
+                animated = animateVisible();
+                runner.record("animated_nodes", animated);
+            } else if(soa && soa_animation) {
+                soa->update();
+                soa->apply();
+            } else if(soa) {
+                soa->updateNodes();
+            } else {
+                for(auto& n : nodes) {
+                    n->roll(Ogre::Radian(0.08));
+                }
+            }
+            runner.record("animate", live.animate = msSince(animateStart));
+            // per node rather than a throughput, --compare takes every metric as lower is better
+            if(animated > 0)
+                runner.record("animate_ns_node", live.animate * 1e6 / animated);
+            if(tlbMisses)
+                runner.record("dtlb_animate", double(tlbMisses->read() - tlbAnimateStart));
         }
 
+        queuedEnd = Clock::now();
         return true;
     }
 
     bool frameEnded(const Ogre::FrameEvent& evt) {
+        runner.record("swap", live.swap = msSince(queuedEnd));
+        if(lastFrameEnd != Clock::time_point())
+            runner.record("frame", live.frame = msSince(lastFrameEnd));
+        else
+            printf("first frame: %.2f ms after main, %.0f ms after exec\n", msSince(mainStart), msSinceExec());
+
+        // not part of the next frame time
+        if(lod || sweep_lod)
+            recordLodSelection();
+        lastFrameEnd = Clock::now();
+
+#if OGRE_VERSION_MAJOR != 2
+        if(cluster_size > 0 || sweep_cluster) {
+            runner.record("cull", culling.getTime());
+            runner.record("cull_tested", countCullingTests());
+            runner.record("visible_objects", visibility.getVisibleCount());
+        }
+        culling.nextFrame();
+
+        if(!camera_counts.empty())
+            recordViewports();
+        viewportTimer.nextFrame();
+
+        if(sweep_listeners) {
+            runner.record("rq_dispatch", rqProbe.getTime());
+            runner.record("rq_groups", rqProbe.getGroups());
+        }
+        rqProbe.nextFrame();
+#endif
+
+        if(!light_counts.empty()) {
+            runner.record("light_find", lightQueries.getTime());
+            runner.record("light_queries", lightQueries.getQueries());
+        }
+        lightQueries.nextFrame();
+
+#if OGRE_VERSION_MAJOR != 2
+        if(!light_counts.empty() || lod || sweep_lod) {
+            auto stats = getRenderWindow()->getStatistics();
+            runner.record("batches", stats.batchCount);
+            runner.record("triangles", stats.triangleCount);
+        }
+#endif
+
+        if(getAsyncLog()) {
+            size_t queued = getAsyncLog()->getQueued() + getAsyncLog()->getDropped();
+            runner.record("log_messages", queued - logMessages);
+            logMessages = queued;
+        }
+
+        if(!runner.nextFrame())
+            getRoot()->queueEndRendering();
+
+        visibility.nextFrame();
+        if(publisher.isOpen()) {
+            // replaces the status line, so a soak run never blocks on the terminal
+            publishFrame();
+            return true;
+        }
+
 #if OGRE_VERSION_MAJOR == 2
         auto stats = Ogre::Root::getSingleton().getFrameStats();
         printf("frametime %f ms (mean %f ms)\t\t\r", 1000./stats->getFps(), 1000./stats->getAvgFps());
@@ -47,8 +284,110 @@ public:
 
     bool rotate_cubes = false;
 
-    std::vector<Ogre::SceneNode*> nodes;
+    Benchmark::ScenarioRunner runner;
+    bool sweep_campos = false;
+    bool pipelined = false;
+    bool sweep_pipeline = false;
+    std::unique_ptr<Benchmark::PipelinedAnimator> animator;
+    Clock::time_point frameStart, queuedEnd, lastFrameEnd, animateStart;
+
+    Benchmark::MetricsPublisher publisher;
+    Benchmark::LiveMetrics::Frame live = {}; // the current frame as published
+    Benchmark::VisibilityTracker visibility;
+    std::vector<size_t> nodeVisibility; // tracker index of the first object of every animated node
+
+    bool lazy_animation = false;
+    bool sweep_lazy = false;
+    std::vector<uint32_t> pendingRolls; // frames of rotation a culled node is behind
+
+    std::vector<int> light_counts; // one scenario each
+    float light_range = 5;
+    std::string light_type = "mixed"; // point, spot or mixed
+    bool move_lights = false;
+    bool sweep_instancing = false;
+    std::vector<Ogre::SceneNode*> lightNodes; // the scattered lights
+    Benchmark::LightQueryTimer lightQueries;
+
+    std::vector<int> character_counts; // one scenario each
+    std::string character_mesh = "jaiqua.mesh";
+    std::string character_animation = "Sneak";
+    bool parallel_skeletons = false;
+    bool sweep_skeletons = false;
+    bool software_skinning = false; // forced even where the material could skin in hardware
+    bool sweep_skinning = false;
+    std::vector<Ogre::Entity*> characters;
+    std::vector<Ogre::AnimationState*> characterStates;
+    bool charactersWarm = false; // the first update after spawning builds caches, so it is serial
+
+    Clock::time_point mainStart;
+
+    bool arena = false;           // a new arena for every grid
+    bool arena_hugepages = false;
+    bool sweep_arena = false;
+    size_t arena_size = size_t(4) << 30; // address space per arena
+    Benchmark::Arena* gridArena = NULL;
+    std::unique_ptr<Benchmark::PerfCounter> tlbMisses; // of the whole process
+    uint64_t tlbFrameStart = 0, tlbAnimateStart = 0;
+
+    bool sweep_listeners = false;
+    size_t synthetic_listeners = 16; // of every kind
+    std::vector<std::unique_ptr<Benchmark::SyntheticListener> > syntheticListeners;
+    Benchmark::RenderQueueProbe rqProbe;
+
+    bool quiet_frames = false; // only critical log messages while measuring
+    size_t logMessages = 0;    // logged asynchronously until the last frame
+
+    std::vector<int> camera_counts; // one scenario each
+    bool camera_textures = false; // the extra cameras render to textures instead of window viewports
+    int camera_texture_size = 512;
+    std::vector<Ogre::Camera*> extraCameras;
+    std::vector<Ogre::TexturePtr> cameraTextures; // one per extra camera, if camera_textures
+    Benchmark::ViewportTimer viewportTimer;
+
+    int cluster_size = 0; // grid cells per cluster side, 0 for a flat grid
+    bool sweep_cluster = false;
+    std::vector<Ogre::SceneNode*> clusterNodes; // parents of the grid nodes, if clustered
+    Benchmark::CullingTimer culling;
+
+    std::string grid_mesh = "Cube_d.mesh"; // when not instancing
+    bool lod = false;
+    bool sweep_lod = false;
+    std::string lod_strategy = "distance_sphere"; // of LodStrategyManager
+    std::vector<Benchmark::MeshLod::Level> lod_levels; // empty for the defaults of the strategy
+    int lod_segments = 64;
+    std::vector<Ogre::Entity*> lodEntities; // visible in the last frame
+
+    bool soa_animation = false;
+    bool sweep_soa = false;
+    Benchmark::SoaAnimator::Motion motion = Benchmark::SoaAnimator::ROLL;
+    std::unique_ptr<Benchmark::SoaAnimator> soa; // also the node loop of motions other than roll
+
+    int grid_size = 140;
+#ifdef HW_BASIC
+    bool hw_instancing = true;
+#else
+    bool hw_instancing = false;
+#endif
+    bool bulk_create = false;
+    int construction_runs = 0;
+    std::string snapshot_save, snapshot_load, dotscene_load;
+    int queries = 0; // of every kind per frame
+    std::unique_ptr<Benchmark::SceneQueryBenchmark> queryBench;
+    int multi_scenes = 0;
+    int multi_scene_frames = 200;
+    std::vector<Benchmark::ScenarioResult> extraResults; // measured outside of the render loop
+
+    double autotune_budget = 0; // ms, 0 to disable
+    double autotune_percentile = 0.99;
+    int autotune_max = 1000;    // largest grid size to probe
+    std::vector<int> autotune_workers;
+    std::unique_ptr<Benchmark::Autotuner> autotuner;
+
+    Ogre::SceneManager* scnMgr;
+    std::vector<Ogre::SceneNode*> nodes;      // the animated nodes
+    std::vector<Ogre::SceneNode*> gridNodes;  // all nodes owned by the grid, parents first
     Ogre::SceneNode* camNode;
+    Ogre::Camera* camera;
     int pos = 2;
     std::vector<Ogre::Vector3> campos = {Ogre::Vector3(0, 1, -1), Ogre::Vector3(0, 10, -10), Ogre::Vector3(0, 70, -70)};
 };
@@ -66,21 +405,249 @@ bool MyTestApp::keyPressed(const Bites::KeyboardEvent& evt)
 
     if (evt.keysym.sym == SDLK_ESCAPE)
     {
-        printf("\n\n");
-        exit(0);
+        // end gracefully, so results and input recordings get written
         getRoot()->queueEndRendering();
     }
 
     if (evt.keysym.sym == 'c')
     {
-        camNode->setPosition( campos[++pos % campos.size()] );
-        camNode->lookAt( Ogre::Vector3(0,0,0) , Ogre::SceneNode::TS_PARENT);
+        setCameraPosition(++pos);
     }
 
     return true;
 }
 //! [key_handler]
 
+void MyTestApp::setCameraPosition(int i)
+{
+    pos = i;
+    camNode->setPosition( campos[pos % campos.size()] );
+    camNode->lookAt( Ogre::Vector3(0,0,0) , Ogre::SceneNode::TS_PARENT);
+    placeExtraCameras();
+}
+
+/**
+ * @p count cameras over the same scene: the main one and count - 1 more, either tiling
+ * the window with it or each rendering to its own texture
+ */
+void MyTestApp::setCameraCount(size_t count)
+{
+#if OGRE_VERSION_MAJOR != 2
+    using namespace Ogre;
+
+    // the layout depends on the count, so start over
+    RenderWindow* window = getRenderWindow();
+    for(size_t i = 0; i < extraCameras.size(); ++i)
+    {
+        if(camera_textures)
+            TextureManager::getSingleton().remove(cameraTextures[i]);
+        else
+            window->removeViewport(int(i + 1));
+
+        SceneNode* n = extraCameras[i]->getParentSceneNode();
+        n->detachObject(extraCameras[i]);
+        scnMgr->destroySceneNode(n);
+        scnMgr->destroyCamera(extraCameras[i]);
+    }
+    extraCameras.clear();
+    cameraTextures.clear();
+    viewportTimer.clear();
+
+    int columns = camera_textures ? 1 : std::max(1, int(std::ceil(std::sqrt(float(count)))));
+    int rows = camera_textures ? 1 : (int(count) + columns - 1) / columns;
+    float w = 1.0f / columns, h = 1.0f / rows;
+    window->getViewport(0)->setDimensions(0, 0, w, h);
+
+    for(size_t i = 1; i < count; ++i)
+    {
+        Camera* cam = scnMgr->createCamera("extraCam" + std::to_string(i));
+        cam->setAutoAspectRatio(true);
+        cam->setNearClipDistance(camera->getNearClipDistance());
+        cam->setFarClipDistance(camera->getFarClipDistance());
+        scnMgr->getRootSceneNode()->createChildSceneNode()->attachObject(cam);
+        extraCameras.push_back(cam);
+
+        if(camera_textures)
+        {
+            TexturePtr tex = TextureManager::getSingleton().createManual(
+                "extraCamTex" + std::to_string(i), ResourceGroupManager::DEFAULT_RESOURCE_GROUP_NAME, TEX_TYPE_2D,
+                camera_texture_size, camera_texture_size, 0, PF_R8G8B8A8, TU_RENDERTARGET);
+            RenderTarget* rt = tex->getBuffer()->getRenderTarget();
+            rt->addViewport(cam)->setOverlaysEnabled(false);
+            rt->addListener(&viewportTimer);
+            rt->setAutoUpdated(true);
+            cameraTextures.push_back(tex);
+        }
+        else
+        {
+            window->addViewport(cam, int(i), w * (i % columns), h * (i / columns), w, h);
+        }
+    }
+    placeExtraCameras();
+#else
+    if(count > 1)
+        printf("multiple cameras need Ogre 1.x\n");
+#endif
+}
+
+/**
+ * switches the per-frame hooks one at a time: the overlay system as render queue
+ * listener, this as input listener and @p count synthetic frame, render queue and
+ * input listeners. The render queue listeners are timed by the probe.
+ */
+void MyTestApp::setListeners(bool overlay, bool input, size_t count)
+{
+#if OGRE_VERSION_MAJOR != 2
+    rqProbe.detach(); // also removes the listeners it bracketed
+    for(auto& l : syntheticListeners)
+    {
+        getRoot()->removeFrameListener(l.get());
+        removeInputListener(l.get());
+    }
+    syntheticListeners.clear();
+
+    std::vector<Ogre::RenderQueueListener*> queueListeners;
+    if(overlay)
+        queueListeners.push_back(getOverlaySystem());
+    for(size_t i = 0; i < count; ++i)
+    {
+        syntheticListeners.emplace_back(new Benchmark::SyntheticListener());
+        Benchmark::SyntheticListener* l = syntheticListeners.back().get();
+        getRoot()->addFrameListener(l);
+        addInputListener(l);
+        queueListeners.push_back(l);
+    }
+    rqProbe.attach(scnMgr, queueListeners);
+
+    // keys do not work without it, but a fixed number of frames still ends the run
+    if(input)
+        addInputListener(this);
+    else
+        removeInputListener(this);
+#endif
+}
+
+/// the arena for the next scene. The previous one goes away with its last block.
+void MyTestApp::renewArena()
+{
+    if(gridArena)
+        gridArena->release();
+    gridArena = NULL;
+    if(!arena)
+        return;
+
+    // rather than measuring the heap under the arena label
+    if(!Benchmark::Arena::isInterposed())
+        OGRE_EXCEPT(Ogre::Exception::ERR_NOT_IMPLEMENTED, "arenas need the BENCHMARK_ARENA build",
+                    "MyTestApp::renewArena");
+    if(!(gridArena = Benchmark::Arena::create(arena_size, arena_hugepages)))
+        OGRE_EXCEPT(Ogre::Exception::ERR_INTERNAL_ERROR,
+                    "could not reserve an arena of " + std::to_string(arena_size >> 20) +
+                        " MiB, or too many are kept alive by surviving blocks",
+                    "MyTestApp::renewArena");
+}
+
+void MyTestApp::setArena(bool enable, bool hugePages)
+{
+    arena = enable;
+    arena_hugepages = hugePages;
+    rebuildGrid(grid_size);
+}
+
+/// the extra cameras circle the grid center at the distance and height of the main one
+void MyTestApp::placeExtraCameras()
+{
+    size_t count = extraCameras.size() + 1;
+    for(size_t i = 0; i < extraCameras.size(); ++i)
+    {
+        Ogre::SceneNode* n = extraCameras[i]->getParentSceneNode();
+        Ogre::Quaternion orbit(Ogre::Radian(Ogre::Math::TWO_PI * (i + 1) / count), Ogre::Vector3::UNIT_Y);
+        n->setPosition(orbit * camNode->getPosition());
+        n->lookAt(Ogre::Vector3(0, 0, 0), Ogre::SceneNode::TS_PARENT);
+    }
+}
+
+/**
+ * culling and render queue time of every camera. The scene graph is updated once per
+ * frame with the first camera, so the difference to the others is the shared work.
+ */
+void MyTestApp::recordViewports()
+{
+    const auto& entries = viewportTimer.getEntries();
+    double cull = 0, update = 0;
+    for(size_t i = 0; i < entries.size(); ++i)
+    {
+        const auto& e = entries[i];
+        runner.record("cam" + std::to_string(i) + "_cull", e.cull);
+        runner.record("cam" + std::to_string(i) + "_queue", e.update - e.cull);
+        cull += e.cull;
+        update += e.update;
+    }
+    if(entries.empty())
+        return;
+
+    runner.record("cull_total", cull);
+    runner.record("viewports_total", update);
+    runner.record("viewport_first", entries[0].update);
+    if(entries.size() > 1)
+        runner.record("viewport_others", (update - entries[0].update) / (entries.size() - 1));
+}
+
+void MyTestApp::setLazyAnimation(bool enable)
+{
+#if OGRE_VERSION_MAJOR == 2
+    enable = false; // no visibility tracking
+#endif
+    // catch up, so the eager mode continues from the same state
+    for(size_t i = 0; i < pendingRolls.size(); ++i)
+    {
+        if(pendingRolls[i])
+            nodes[i]->roll(Ogre::Radian(0.08f * pendingRolls[i]));
+    }
+
+    lazy_animation = enable;
+    pendingRolls.assign(enable ? nodes.size() : 0, 0);
+}
+
+/**
+ * only roll the nodes whose objects passed culling in the frame just queued, culled
+ * ones accumulate their rotation and apply it in one step once visible again
+ * @return number of nodes updated
+ */
+size_t MyTestApp::animateVisible()
+{
+    size_t updated = 0;
+    for(size_t i = 0; i < nodes.size(); ++i)
+    {
+        size_t idx = nodeVisibility[i];
+        ++pendingRolls[i];
+        if(idx != Benchmark::VisibilityTracker::NEVER && !visibility.isVisibleThisFrame(idx))
+            continue;
+
+        nodes[i]->roll(Ogre::Radian(0.08f * pendingRolls[i]));
+        pendingRolls[i] = 0;
+        ++updated;
+    }
+    return updated;
+}
+
+void MyTestApp::setSoaAnimation(bool enable)
+{
+    soa_animation = enable;
+    soa.reset();
+    if(rotate_cubes && (enable || motion != Benchmark::SoaAnimator::ROLL))
+        soa.reset(new Benchmark::SoaAnimator(nodes, motion, 0.08f, getJobSystem()));
+}
+
+void MyTestApp::setPipelined(bool enable)
+{
+    animator.reset();
+    animateStart = Clock::time_point();
+
+    if(enable && rotate_cubes)
+        animator.reset(new Benchmark::PipelinedAnimator(nodes, Ogre::Radian(0.08), getJobSystem()));
+}
+
 //! [setup]
 void MyTestApp::setup(void)
 {
@@ -112,7 +679,9 @@ void MyTestApp::setup(void)
     if(prof)
         prof->setEnabled(true);
 
-    scnMgr->addRenderQueueListener(getOverlaySystem());
+    // registered behind the probe in listener mode
+    if(!sweep_listeners)
+        scnMgr->addRenderQueueListener(getOverlaySystem());
 
 
     // without light we would just get a black screen
@@ -141,8 +710,9 @@ void MyTestApp::setup(void)
     scnMgr->getRootSceneNode()->detachObject(cam);
 #endif
     camNode->attachObject(cam);
+    camera = cam;
     camNode->setFixedYawAxis(true);
-    camNode->setPosition( campos[pos] );
+    camNode->setPosition( campos[pos % campos.size()] );
     camNode->lookAt( Vector3(0,0,0) , SceneNode::TS_PARENT);
 
     // and tell it to render into the main window
@@ -153,57 +723,1235 @@ void MyTestApp::setup(void)
     getRenderWindow()->addViewport(cam);
 #endif
 
+    this->scnMgr = scnMgr;
+#if OGRE_VERSION_MAJOR != 2
+    scnMgr->addListener(&culling);
+    if(!camera_counts.empty())
+    {
+        scnMgr->addListener(&viewportTimer);
+        getRenderWindow()->addListener(&viewportTimer);
+    }
+#endif
+    buildScene();
+
+    if(multi_scenes > 0)
+        benchmarkMultiScene();
+
+    if(queries > 0)
+        queryBench.reset(new Benchmark::SceneQueryBenchmark(scnMgr, gridNodes));
+
+    setSoaAnimation(soa_animation);
+    if(soa_animation || sweep_soa)
+        printf("soa animation kernels: %s\n", Benchmark::SoaAnimator::getInstructionSet());
+
+    if(autotune_budget > 0)
+    {
+        setupAutotune();
+        runner.start();
+        return;
+    }
+
+    typedef Benchmark::ScenarioRunner::Variant Variant;
+
+    // outermost, so the grid is only rebuilt once per technique
+    if(sweep_instancing)
+        runner.addAxis({{"entity", [this]() { hw_instancing = false; rebuildGrid(grid_size); }},
+                        {"instancing", [this]() { hw_instancing = true; rebuildGrid(grid_size); }}});
+
+    if(sweep_cluster)
+    {
+        int size = cluster_size > 0 ? cluster_size : 8;
+        runner.addAxis({{"flat", [this]() { cluster_size = 0; rebuildGrid(grid_size); }},
+                        {"cluster" + std::to_string(size), [this, size]() {
+                             cluster_size = size;
+                             rebuildGrid(grid_size);
+                         }}});
+    }
+
+    if(sweep_arena)
+        runner.addAxis({{"heap", [this]() { setArena(false, false); }},
+                        {"arena", [this]() { setArena(true, false); }},
+                        {"arena_thp", [this]() { setArena(true, true); }}});
+
+    if(sweep_lod)
+        runner.addAxis({{"nolod", [this]() { setMeshLod(false); }},
+                        {"lod", [this]() { setMeshLod(true); }}});
+    else if(lod)
+        runner.addAxis({{"lod", [this]() { setMeshLod(true); }}});
+
+    std::vector<Variant> cameras;
+    for(size_t i = 0; i < campos.size(); ++i)
+    {
+        if(sweep_campos || i == pos % campos.size())
+            cameras.push_back({"campos" + std::to_string(i), [this, i]() { setCameraPosition(i); }});
+    }
+    runner.addAxis(cameras);
+
+    std::vector<Variant> cameraCounts;
+    for(int n : camera_counts)
+        cameraCounts.push_back({"cameras" + std::to_string(n), [this, n]() { setCameraCount(n); }});
+    if(!cameraCounts.empty())
+        runner.addAxis(cameraCounts);
+
+    if(sweep_lazy)
+        runner.addAxis({{"eager", [this]() { setLazyAnimation(false); }},
+                        {"lazy", [this]() { setLazyAnimation(true); }}});
+    else if(lazy_animation)
+        runner.addAxis({{"lazy", [this]() { setLazyAnimation(true); }}});
+
+    std::vector<Variant> lightCounts;
+    for(int n : light_counts)
+        lightCounts.push_back({"lights" + std::to_string(n), [this, n]() { setLightCount(n); }});
+    if(!lightCounts.empty())
+        runner.addAxis(lightCounts);
+
+    std::vector<Variant> characterCounts;
+    for(int n : character_counts)
+        characterCounts.push_back({"characters" + std::to_string(n), [this, n]() { setCharacterCount(n); }});
+    if(!characterCounts.empty())
+        runner.addAxis(characterCounts);
+
+    if(sweep_skinning)
+        runner.addAxis({{"hwskin", [this]() { setSoftwareSkinning(false); }},
+                        {"swskin", [this]() { setSoftwareSkinning(true); }}});
+
+    if(sweep_skeletons)
+        runner.addAxis({{"serial_skeletons", [this]() { parallel_skeletons = false; }},
+                        {"parallel_skeletons", [this]() { parallel_skeletons = true; }}});
+
+    if(sweep_soa)
+        runner.addAxis({{"loop", [this]() { setSoaAnimation(false); }},
+                        {"soa", [this]() { setSoaAnimation(true); }}});
+
+    if(sweep_listeners)
+    {
+        size_t n = synthetic_listeners;
+        runner.addAxis({{"listeners", [this]() { setListeners(true, true, 0); }},
+                        {"no_overlay", [this]() { setListeners(false, true, 0); }},
+                        {"no_input", [this]() { setListeners(true, false, 0); }},
+                        {"synthetic" + std::to_string(n), [this, n]() { setListeners(true, true, n); }}});
+    }
+
+    if(sweep_pipeline)
+        runner.addAxis({{"serial", [this]() { setPipelined(false); }},
+                        {"pipelined", [this]() { setPipelined(true); }}});
+    else if(pipelined)
+        runner.addAxis({{"pipelined", [this]() { setPipelined(true); }}});
+
+    runner.start();
+}
+//! [setup]
+
+//! [grid]
+static Ogre::MovableObject* createCube(Ogre::SceneManager* scnMgr, Ogre::InstanceManager* instanceManager,
+                                       const Ogre::String& mesh = "Cube_d.mesh")
+{
+    if(!instanceManager)
+        return scnMgr->createEntity( mesh );
+
+#if OGRE_VERSION_MAJOR == 2
+    return instanceManager->createInstancedEntity("Examples/Instancing/HWBasic/Cube", SCENE_TYPE_PARAM);
+#else
+    return instanceManager->createInstancedEntity("Examples/Instancing/HWBasic/Cube");
+#endif
+}
+
+Ogre::Vector3 MyTestApp::gridPosition(int i, int j) const
+{
+    return Ogre::Vector3( 0.5f * (i - grid_size/2), 0.0f, 0.5f * (j - grid_size/2));
+}
+
+size_t MyTestApp::clusterOf(int i, int j) const
+{
+    int tiles = (grid_size + cluster_size - 1) / cluster_size;
+    return (i / cluster_size) * tiles + j / cluster_size;
+}
+
+/**
+ * one parent node per cluster_size x cluster_size tile, in the middle of its cells. The
+ * bounds of a node include all its children, so culling skips the children of a
+ * parent outside the frustum.
+ */
+void MyTestApp::createClusters()
+{
+    if(cluster_size <= 0)
+        return;
+
+    int tiles = (grid_size + cluster_size - 1) / cluster_size;
+    for(int ti = 0; ti < tiles; ++ti)
+    {
+        for(int tj = 0; tj < tiles; ++tj)
+        {
+            int i0 = ti * cluster_size, i1 = std::min(grid_size, i0 + cluster_size) - 1;
+            int j0 = tj * cluster_size, j1 = std::min(grid_size, j0 + cluster_size) - 1;
+            Ogre::Vector3 center = 0.5f * (gridPosition(i0, j0) + gridPosition(i1, j1));
+
+            Ogre::SceneNode* n = scnMgr->getRootSceneNode()->createChildSceneNode(center);
+            clusterNodes.push_back(n);
+            gridNodes.push_back(n);
+        }
+    }
+}
+
+/// frustum tests of the last culling pass: every node below a visible parent is tested
+size_t MyTestApp::countCullingTests() const
+{
+    if(clusterNodes.empty())
+        return nodes.size();
+
+    size_t tested = clusterNodes.size();
+#if OGRE_VERSION_MAJOR != 2
+    for(auto c : clusterNodes)
+    {
+        if(camera->isVisible(c->_getWorldAABB()))
+            tested += c->numChildren();
+    }
+#endif
+    return tested;
+}
+
+void MyTestApp::createGrid()
+{
+    using namespace Ogre;
+
     // finally something to render
-    const int numW = 140;
-    const int numH = 140;
+    const int numW = grid_size;
+    const int numH = grid_size;
 
     nodes.reserve(numW*numH);
+    gridNodes.reserve(numW*numH);
+    createClusters();
 
-#ifdef HW_BASIC
-    auto instanceManager = scnMgr->createInstanceManager(
-        "InstanceMgr", "Cube_d.mesh",
-        RGN_DEFAULT, InstanceManager::HWInstancingBasic,
-        numW * numH);
-#endif
+    InstanceManager* instanceManager = NULL;
+    if(hw_instancing)
+    {
+        instanceManager = scnMgr->createInstanceManager(
+            "InstanceMgr", "Cube_d.mesh",
+            RGN_DEFAULT, InstanceManager::HWInstancingBasic,
+            numW * numH);
+    }
 
     //AnimationState *animState;
     for( int i=0; i<numH; ++i )
     {
         for( int j=0; j<numW; ++j )
         {
-            SceneNode *sceneNode = scnMgr->getRootSceneNode()->createChildSceneNode();
-#ifdef HW_BASIC
-#if OGRE_VERSION_MAJOR == 2
-            InstancedEntity *ent = instanceManager->createInstancedEntity(
-                                                "Examples/Instancing/HWBasic/Cube",
-                                                SCENE_TYPE_PARAM );
-#else
-            InstancedEntity *ent = instanceManager->createInstancedEntity(
-                                                "Examples/Instancing/HWBasic/Cube" );
-#endif
-#else
-            Entity *ent = scnMgr->createEntity( "Cube_d.mesh" );
+            SceneNode *parent = clusterNodes.empty() ? scnMgr->getRootSceneNode() : clusterNodes[clusterOf(i, j)];
+            SceneNode *sceneNode = parent->createChildSceneNode();
+            MovableObject *ent = createCube(scnMgr, instanceManager, grid_mesh);
             //ent->setMaterialName("Examples/BeachStones");
-#endif
             sceneNode->attachObject( ent );
-            sceneNode->setPosition( Vector3( 0.5f * (i - numH/2), 0.0f, 0.5f * (j -numW/2)) );
+            sceneNode->setPosition( gridPosition(i, j) - parent->getPosition() );
             sceneNode->scale( 0.2f, 0.2f, 0.2f );
             nodes.push_back(sceneNode);
+            gridNodes.push_back(sceneNode);
         }
     }
 }
-//! [setup]
+
+void MyTestApp::createGridBulk()
+{
+    using namespace Ogre;
+
+    const int numW = grid_size;
+    const int numH = grid_size;
+
+    // the transforms of every parent, relative to it
+    createClusters();
+    std::vector<SceneNode*> parents = clusterNodes;
+    if(parents.empty())
+        parents.push_back(scnMgr->getRootSceneNode());
+    std::vector<std::vector<Benchmark::NodeTransform> > transforms(parents.size());
+
+    for( int i=0; i<numH; ++i )
+    {
+        for( int j=0; j<numW; ++j )
+        {
+            size_t p = clusterNodes.empty() ? 0 : clusterOf(i, j);
+            Benchmark::NodeTransform t;
+            t.position = gridPosition(i, j) - parents[p]->getPosition();
+            t.orientation = Quaternion::IDENTITY;
+            t.scale = Vector3(0.2f);
+            transforms[p].push_back(t);
+        }
+    }
+
+    Benchmark::BulkSceneBuilder::ObjectFactory factory;
+    if(hw_instancing)
+    {
+        InstanceManager* instanceManager = scnMgr->createInstanceManager(
+            "InstanceMgr", "Cube_d.mesh",
+            RGN_DEFAULT, InstanceManager::HWInstancingBasic,
+            numW * numH);
+        factory = [this, instanceManager](size_t) { return createCube(scnMgr, instanceManager); };
+    }
+    else
+    {
+        factory = Benchmark::BulkSceneBuilder::entityFactory(scnMgr, grid_mesh);
+    }
+
+    std::vector<SceneNode*> created;
+    for(size_t p = 0; p < parents.size(); ++p)
+        Benchmark::BulkSceneBuilder::createChildSceneNodes(parents[p], transforms[p], created, factory);
+    gridNodes.insert(gridNodes.end(), created.begin(), created.end());
+    nodes = created;
+}
+
+void MyTestApp::destroyGrid()
+{
+    using namespace Ogre;
+
+    for(auto n : gridNodes)
+    {
+        while(n->numAttachedObjects())
+        {
+            MovableObject* o = n->detachObject((unsigned short)0);
+            if(InstancedEntity* ient = dynamic_cast<InstancedEntity*>(o))
+                scnMgr->destroyInstancedEntity(ient);
+            else
+                scnMgr->destroyMovableObject(o);
+        }
+    }
+
+    // children first
+    for(auto it = gridNodes.rbegin(); it != gridNodes.rend(); ++it)
+        scnMgr->destroySceneNode(*it);
+
+    gridNodes.clear();
+    nodes.clear();
+    clusterNodes.clear();
+
+    if(scnMgr->hasInstanceManager("InstanceMgr"))
+        scnMgr->destroyInstanceManager("InstanceMgr");
+}
+
+/// replace the scene by a procedural grid of @p size, keeping the animation mode
+void MyTestApp::rebuildGrid(int size)
+{
+    bool pipeline = animator != nullptr;
+    animator.reset();
+    soa.reset();
+    queryBench.reset();
+    pendingRolls.clear();
+    // the objects call their listeners while being detached and destroyed
+    destroyGrid();
+    visibility.clear();
+    lightQueries.clear();
+    grid_size = size;
+    renewArena();
+    {
+        Benchmark::ArenaScope scope(gridArena);
+        if(bulk_create)
+            createGridBulk();
+        else
+            createGrid();
+    }
+    trackVisibility();
+    trackLightQueries();
+
+    setLazyAnimation(lazy_animation);
+    setSoaAnimation(soa_animation);
+    setPipelined(pipeline);
+    if(queries > 0)
+        queryBench.reset(new Benchmark::SceneQueryBenchmark(scnMgr, gridNodes));
+}
+
+/// one search per technique and worker count, all at the current camera position
+void MyTestApp::setupAutotune()
+{
+    autotuner.reset(new Benchmark::Autotuner(runner, autotune_budget, autotune_percentile, autotune_max,
+                                             [this](int size) { rebuildGrid(size); }));
+
+    std::vector<int> workers = autotune_workers;
+    if(workers.empty())
+        workers.push_back(int(getJobSystem()->getNumWorkers()));
+
+    for(int instancing = 0; instancing < 2; ++instancing)
+    {
+        for(int w : workers)
+        {
+            std::string label = std::string(instancing ? "instancing" : "entity") + "/workers" + std::to_string(w);
+            autotuner->addConfig(label, [this, instancing, w]() {
+                // no jobs may be in flight while the workers are replaced
+                setPipelined(false);
+                hw_instancing = instancing;
+                if(getJobSystem()->getNumWorkers() != size_t(w))
+                    getJobSystem()->setNumWorkers(w);
+                setPipelined(pipelined);
+            });
+        }
+    }
+
+    setCameraPosition(pos);
+    autotuner->start();
+}
+
+void MyTestApp::saveSnapshot(const std::string& path)
+{
+    Benchmark::SceneSnapshotWriter writer;
+    if(hw_instancing)
+        writer.addInstanceManager("InstanceMgr", "Cube_d.mesh", Ogre::InstanceManager::HWInstancingBasic,
+                                  grid_size * grid_size);
+
+    // only the top level nodes, their children are added recursively
+    for(auto n : gridNodes)
+    {
+        if(n->getParentSceneNode() == scnMgr->getRootSceneNode())
+            writer.addNode(n);
+    }
+
+    if(!writer.write(path) || !writer.writeDotScene(path + ".scene"))
+        printf("could not write snapshot %s\n", path.c_str());
+}
+
+bool MyTestApp::loadSnapshot(const std::string& path)
+{
+    Benchmark::SceneSnapshot snapshot;
+    if(!snapshot.open(path))
+        return false;
+
+    snapshot.instantiate(scnMgr, scnMgr->getRootSceneNode(), gridNodes, nodes);
+    return true;
+}
+
+bool MyTestApp::loadDotScene(const std::string& path)
+{
+#if OGRE_VERSION >= (13 << 16)
+    Ogre::DataStreamPtr stream = Ogre::Root::openFileStream(path);
+    Ogre::SceneNode* parent = scnMgr->getRootSceneNode()->createChildSceneNode();
+    Ogre::SceneLoaderManager::getSingleton().load(stream, Ogre::RGN_DEFAULT, parent);
+
+    gridNodes.push_back(parent);
+    for(auto c : parent->getChildren())
+    {
+        gridNodes.push_back(static_cast<Ogre::SceneNode*>(c));
+        nodes.push_back(static_cast<Ogre::SceneNode*>(c));
+    }
+    return true;
+#else
+    printf("DotScene import needs Ogre 13 or later\n");
+    return false;
+#endif
+}
+
+void MyTestApp::buildScene()
+{
+    auto start = Clock::now();
+    const char* source = "procedural";
+
+    renewArena();
+    {
+        // the nodes, objects and their containers, if arenas are enabled
+        Benchmark::ArenaScope scope(gridArena);
+        if(!snapshot_load.empty())
+        {
+            source = "snapshot";
+            if(!loadSnapshot(snapshot_load))
+                OGRE_EXCEPT(Ogre::Exception::ERR_FILE_NOT_FOUND, "could not load snapshot " + snapshot_load,
+                            "MyTestApp::buildScene");
+        }
+        else if(!dotscene_load.empty())
+        {
+            source = "dotscene";
+            if(!loadDotScene(dotscene_load))
+                OGRE_EXCEPT(Ogre::Exception::ERR_FILE_NOT_FOUND, "could not load " + dotscene_load,
+                            "MyTestApp::buildScene");
+        }
+        else if(bulk_create)
+        {
+            source = "bulk";
+            createGridBulk();
+        }
+        else
+        {
+            createGrid();
+        }
+    }
+
+    auto locality = Benchmark::BulkSceneBuilder::measureLocality(nodes);
+    printf("scene construction (%s): %.2f ms, %zu nodes, node stride %.0f B (median), %.1f%% same page\n", source,
+           msSince(start), gridNodes.size(), locality.medianStride, 100 * locality.samePage);
+    if(construction_runs > 0)
+        benchmarkConstruction(construction_runs);
+
+    // of the scene that is measured, which benchmarkConstruction rebuilds
+    if(gridArena)
+        printf("arena: %.1f MiB in %zu blocks%s\n", gridArena->getUsed() / 1048576.0, gridArena->getLiveBlocks(),
+               gridArena->hasHugePages() ? ", transparent huge pages" : "");
+
+    if(!snapshot_save.empty())
+        saveSnapshot(snapshot_save);
+
+    trackVisibility();
+    trackLightQueries();
+}
+
+void MyTestApp::trackVisibility()
+{
+    nodeVisibility.assign(nodes.size(), Benchmark::VisibilityTracker::NEVER);
+#if OGRE_VERSION_MAJOR != 2
+    std::map<Ogre::SceneNode*, size_t> firstObject;
+    for(auto n : gridNodes)
+    {
+        for(unsigned short i = 0; i < n->numAttachedObjects(); ++i)
+        {
+            size_t idx = visibility.track(n->getAttachedObject(i));
+            firstObject.insert(std::make_pair(n, idx));
+        }
+    }
+
+    for(size_t i = 0; i < nodes.size(); ++i)
+    {
+        auto it = firstObject.find(nodes[i]);
+        if(it != firstObject.end())
+            nodeVisibility[i] = it->second;
+    }
+#endif
+}
+
+/// route the light finding of the grid objects, and of the instance batches drawing them, through the timer
+void MyTestApp::trackLightQueries()
+{
+#if OGRE_VERSION_MAJOR != 2
+    if(light_counts.empty())
+        return;
+
+    visibility.setLightQueryListener(&lightQueries);
+    if(!scnMgr->hasInstanceManager("InstanceMgr"))
+        return;
+
+    auto batches = scnMgr->getInstanceManager("InstanceMgr")->getInstanceBatchMapIterator();
+    while(batches.hasMoreElements())
+    {
+        for(auto batch : batches.getNext())
+            batch->setListener(&lightQueries);
+    }
+#endif
+}
+
+/// point and spot lights scattered over the grid. Light i is at the same place for every count.
+void MyTestApp::setLightCount(size_t count)
+{
+    using namespace Ogre;
+
+    while(lightNodes.size() > count)
+    {
+        SceneNode* n = lightNodes.back();
+        scnMgr->destroyMovableObject(n->detachObject((unsigned short)0));
+        scnMgr->destroySceneNode(n);
+        lightNodes.pop_back();
+    }
+
+    float extent = 0.25f * grid_size;
+    while(lightNodes.size() < count)
+    {
+        size_t i = lightNodes.size();
+        std::mt19937 rng(uint32_t(i + 1));
+        std::uniform_real_distribution<float> coord(-extent, extent);
+
+        Light* light = scnMgr->createLight();
+        bool spot = light_type == "spot" || (light_type == "mixed" && i % 2);
+        light->setType(spot ? Light::LT_SPOTLIGHT : Light::LT_POINT);
+        light->setDiffuseColour(ColourValue(0.5f, 0.5f, 0.5f));
+        light->setAttenuation(light_range, 1, 4.5f / light_range, 75 / (light_range * light_range));
+        if(spot)
+            light->setSpotlightRange(Degree(30), Degree(50));
+
+        SceneNode* n = scnMgr->getRootSceneNode()->createChildSceneNode();
+        n->attachObject(light);
+        float x = coord(rng);
+        n->setPosition(x, 1.0f, coord(rng));
+        n->setDirection(Vector3::NEGATIVE_UNIT_Y, Node::TS_WORLD);
+        lightNodes.push_back(n);
+    }
+}
+
+/// circle the lights around the grid center, so the light lists of the lit objects change every frame
+void MyTestApp::moveLights()
+{
+    Ogre::Quaternion step(Ogre::Radian(0.01f), Ogre::Vector3::UNIT_Y);
+    for(auto n : lightNodes)
+        n->setPosition(step * n->getPosition());
+}
+
+/// skinned entities on a grid next to the cubes, each with its own AnimationState
+void MyTestApp::setCharacterCount(size_t count)
+{
+#if OGRE_VERSION_MAJOR != 2
+    using namespace Ogre;
+
+    while(characters.size() > count)
+    {
+        Entity* ent = characters.back();
+        SceneNode* n = ent->getParentSceneNode();
+        n->detachObject(ent);
+        scnMgr->destroyEntity(ent);
+        scnMgr->destroySceneNode(n);
+        characters.pop_back();
+        characterStates.pop_back();
+    }
+
+    int columns = std::max(1, int(std::ceil(std::sqrt(float(count)))));
+    while(characters.size() < count)
+    {
+        size_t i = characters.size();
+        Entity* ent = scnMgr->createEntity(character_mesh);
+        if(!ent->getAllAnimationStates())
+            OGRE_EXCEPT(Exception::ERR_INVALIDPARAMS, character_mesh + " has no animations",
+                        "MyTestApp::setCharacterCount");
+        AnimationState* state = ent->hasAnimationState(character_animation)
+                                    ? ent->getAnimationState(character_animation)
+                                    : ent->getAllAnimationStates()->getAnimationStateIterator().getNext();
+        state->setEnabled(true);
+        state->setLoop(true);
+        state->setTimePosition(std::fmod(0.1f * i, state->getLength())); // out of step
+        if(software_skinning)
+            ent->addSoftwareAnimationRequest(false);
+
+        // next to the cube grid, about one grid cell per character
+        SceneNode* n = scnMgr->getRootSceneNode()->createChildSceneNode();
+        n->attachObject(ent);
+        n->setPosition(0.5f * (i % columns - columns / 2), 0.0f, 0.25f * grid_size + 1 + 0.5f * (i / columns));
+        n->setScale(Vector3(0.2f / ent->getBoundingRadius()));
+
+        characters.push_back(ent);
+        characterStates.push_back(state);
+        charactersWarm = false;
+    }
+
+    if(!characters.empty())
+        printf("%zu x %s/%s, hardware skinning %s\n", characters.size(), character_mesh.c_str(),
+               characterStates[0]->getAnimationName().c_str(),
+               characters[0]->isHardwareAnimationEnabled() ? "supported" : "unsupported");
+#else
+    if(count)
+        printf("skinned characters need the Ogre 1.x skeleton API\n");
+#endif
+}
+
+void MyTestApp::setSoftwareSkinning(bool enable)
+{
+#if OGRE_VERSION_MAJOR != 2
+    if(enable == software_skinning)
+        return;
+
+    for(auto ent : characters)
+    {
+        if(enable)
+            ent->addSoftwareAnimationRequest(false);
+        else
+            ent->removeSoftwareAnimationRequest(false);
+    }
+#endif
+    software_skinning = enable;
+}
+
+/**
+ * advance every AnimationState, then evaluate the skeletons before the scene manager
+ * would, so the render only finds them up to date. Skinning in software locks vertex
+ * buffers, which only the render thread may do, so only hardware skinned characters
+ * are evaluated in parallel.
+ */
+void MyTestApp::updateCharacters(Ogre::Real timeStep)
+{
+#if OGRE_VERSION_MAJOR != 2
+    if(characters.empty())
+        return;
+
+    auto start = Clock::now();
+    {
+        Bites::TraceScope trace("anim_advance", "animation");
+        for(auto state : characterStates)
+            state->addTime(timeStep);
+    }
+    runner.record("anim_advance", msSince(start));
+
+    // also fills the per entity caches isHardwareAnimationEnabled builds on first use
+    bool parallel = parallel_skeletons && charactersWarm && !software_skinning;
+    for(size_t i = 0; parallel && i < characters.size(); ++i)
+        parallel = characters[i]->isHardwareAnimationEnabled();
+
+    start = Clock::now();
+    {
+        Bites::TraceScope trace("skeletons", "animation");
+        auto update = [this](size_t begin, size_t end) {
+            for(size_t i = begin; i < end; ++i)
+                characters[i]->_updateAnimation();
+        };
+
+        if(parallel)
+            getJobSystem()->parallel_for(0, characters.size(), 0, update);
+        else
+            update(0, characters.size());
+    }
+    // evaluation and bone matrices, plus the vertex blending when skinning in software
+    runner.record("skeletons", msSince(start));
+    runner.record("skeletons_parallel", parallel);
+    charactersWarm = true;
+#endif
+}
+
+/// rebuild the grid from a dense sphere, with generated LOD levels if @p enable
+void MyTestApp::setMeshLod(bool enable)
+{
+#if OGRE_VERSION_MAJOR != 2
+    using namespace Ogre;
+
+    if(!MeshManager::getSingleton().resourceExists("LodSphere"))
+    {
+        MeshPtr mesh = Benchmark::MeshLod::createSphere(scnMgr, "LodSphere", lod_segments, lod_segments / 2);
+        if(lod_levels.empty())
+            lod_levels = Benchmark::MeshLod::defaultLevels(lod_strategy);
+
+        MeshPtr lodMesh = Benchmark::MeshLod::createLodCopy(mesh, "LodSphereLod", lod_strategy, lod_levels);
+        if(lodMesh)
+            printf("LodSphere: %d triangles, %d LOD levels (%s)\n", lod_segments * lod_segments,
+                   int(lodMesh->getNumLodLevels()), lod_strategy.c_str());
+        else
+            printf("no LOD levels: needs the MeshLodGenerator component and a known --lod-strategy\n");
+    }
+
+    // instance batches draw every instance with the same LOD
+    if(hw_instancing)
+        printf("LOD scenarios use entities instead of instancing\n");
+    hw_instancing = false;
+    grid_mesh = enable && MeshManager::getSingleton().resourceExists("LodSphereLod") ? "LodSphereLod" : "LodSphere";
+    rebuildGrid(grid_size);
+#endif
+}
+
+/// replicate the LOD selection of the objects that passed culling and time it
+void MyTestApp::recordLodSelection()
+{
+#if OGRE_VERSION_MAJOR != 2
+    lodEntities.clear();
+    for(size_t i = 0; i < nodes.size(); ++i)
+    {
+        size_t idx = nodeVisibility[i];
+        if(idx == Benchmark::VisibilityTracker::NEVER || !visibility.isVisibleThisFrame(idx))
+            continue;
+        if(auto ent = dynamic_cast<Ogre::Entity*>(nodes[i]->getAttachedObject(0)))
+            lodEntities.push_back(ent);
+    }
+
+    size_t lodSum = 0;
+    runner.record("lod_select", Benchmark::MeshLod::selectLods(lodEntities, camera, lodSum));
+    runner.record("lod_objects", lodEntities.size());
+    runner.record("lod_mean", lodEntities.empty() ? 0 : double(lodSum) / lodEntities.size());
+#endif
+}
+
+void MyTestApp::publishFrame()
+{
+    live.visibleObjects = uint32_t(visibility.getVisibleCount());
+#if OGRE_VERSION_MAJOR != 2
+    auto stats = getRenderWindow()->getStatistics();
+    live.batches = uint32_t(stats.batchCount);
+    live.triangles = uint32_t(stats.triangleCount);
+#endif
+    publisher.publish(live);
+
+    uint64_t number = live.number;
+    live = Benchmark::LiveMetrics::Frame();
+    live.number = number + 1;
+}
+
+/// build and destroy the grid with every construction path, then restore the scene
+void MyTestApp::benchmarkConstruction(int repetitions)
+{
+    typedef std::function<void()> Builder;
+    std::vector<std::pair<std::string, Builder> > builders = {
+        {"per-node loop", [this]() { createGrid(); }},
+        {"bulk", [this]() { createGridBulk(); }}};
+    if(!snapshot_load.empty())
+        builders.push_back({"snapshot", [this]() { loadSnapshot(snapshot_load); }});
+    if(!dotscene_load.empty())
+        builders.push_back({"dotscene", [this]() { loadDotScene(dotscene_load); }});
+
+    destroyGrid();
+
+    printf("\n%-16s %10s %10s %14s %10s %12s\n", "construction", "min (ms)", "p50 (ms)", "stride (B)", "same page",
+           "span (B/node)");
+    for(auto& b : builders)
+    {
+        std::vector<double> times;
+        Benchmark::BulkSceneBuilder::Locality locality;
+        for(int r = 0; r < repetitions; ++r)
+        {
+            auto start = Clock::now();
+            b.second();
+            times.push_back(msSince(start));
+            locality = Benchmark::BulkSceneBuilder::measureLocality(nodes);
+            destroyGrid();
+        }
+        printf("%-16s %10.2f %10.2f %14.0f %9.1f%% %12.0f\n", b.first.c_str(),
+               *std::min_element(times.begin(), times.end()), Benchmark::percentile(times, 0.5),
+               locality.medianStride, 100 * locality.samePage, locality.span);
+    }
+    printf("\n");
+
+    // the scene the rest of the run uses, in a fresh arena like the one it replaces
+    renewArena();
+    Benchmark::ArenaScope scope(gridArena);
+    if(!snapshot_load.empty())
+        loadSnapshot(snapshot_load);
+    else if(!dotscene_load.empty())
+        loadDotScene(dotscene_load);
+    else if(bulk_create)
+        createGridBulk();
+    else
+        createGrid();
+}
+
+/// update and cull 1..K independent scene managers concurrently and report the scaling
+void MyTestApp::benchmarkMultiScene()
+{
+    Bites::JobSystem* jobs = getJobSystem();
+    Benchmark::MultiSceneBenchmark bench(getRoot(), jobs);
+    bench.createScenes(multi_scenes, grid_size);
+
+    printf("\n%-8s %8s %12s %12s %12s %11s\n", "scenes", "threads", "p50 (ms)", "mean (ms)", "Mnodes/s",
+           "efficiency");
+    double baseThroughput = 0;
+    for(int k = 1; k <= multi_scenes; ++k)
+    {
+        std::vector<double> times = bench.run(k, multi_scene_frames, rotate_cubes);
+
+        double throughput = k * bench.getNodesPerScene() / (Benchmark::mean(times) / 1000); // nodes/s
+        if(k == 1)
+            baseThroughput = throughput;
+
+        printf("%-8d %8zu %12.3f %12.3f %12.2f %10.1f%%\n", k, std::min<size_t>(k, jobs->getNumWorkers() + 1),
+               Benchmark::percentile(times, 0.5), Benchmark::mean(times), throughput / 1e6,
+               100 * throughput / (k * baseThroughput));
+
+        Benchmark::ScenarioResult r;
+        r.name = "multiscene" + std::to_string(k);
+        r.metrics["update"] = times;
+        extraResults.push_back(r);
+    }
+    printf("\n");
+}
+//! [grid]
+
+//! [options]
+struct Options
+{
+    size_t warmup = 50;
+    size_t frames = 0;
+    std::string output;
+    std::string compare;
+    double threshold = 5;   // percent
+    double alpha = 0.01;
+    std::string record;
+    std::string replay;
+    float fixedStep = 0;    // seconds
+    std::string trace;
+    std::string publish;
+    int pinMain = -1;       // cpu
+    std::string pinWorkers; // cpu list or "node"
+    int numaNode = -1;
+    bool topology = false;
+    std::string preload;    // resource groups
+    bool preloadSync = false;
+    size_t asyncLog = 0;    // queue capacity, 0 logs synchronously
+    bool tlb = false;       // count data TLB misses
+};
+
+static bool parseArgs(const std::vector<std::string>& args, MyTestApp& app, Options& opts)
+{
+    for(const std::string& arg : args)
+    {
+        auto value = [&arg]() { return arg.substr(arg.find('=') + 1); };
+
+        if(arg.compare(0, 2, "--") != 0)
+            app.rotate_cubes = atoi(arg.c_str()); // legacy positional flag
+        else if(arg == "--rotate")
+            app.rotate_cubes = true;
+        else if(arg.find("--campos=") == 0)
+            app.pos = atoi(value().c_str());
+        else if(arg == "--sweep-campos")
+            app.sweep_campos = true;
+        else if(arg == "--pipelined")
+            app.rotate_cubes = app.pipelined = true;
+        else if(arg == "--lazy-animation")
+            app.rotate_cubes = app.lazy_animation = true;
+        else if(arg == "--sweep-lazy")
+            app.rotate_cubes = app.sweep_lazy = true;
+        else if(arg.find("--lights=") == 0)
+            app.light_counts = Bites::parseCpuList(value());
+        else if(arg == "--light-scaling")
+            app.light_counts = {1, 2, 4, 8, 16, 32, 64, 128, 256};
+        else if(arg.find("--light-range=") == 0)
+            app.light_range = atof(value().c_str());
+        else if(arg.find("--light-type=") == 0)
+            app.light_type = value();
+        else if(arg == "--move-lights")
+            app.move_lights = true;
+        else if(arg.find("--cameras=") == 0)
+            app.camera_counts = Bites::parseCpuList(value());
+        else if(arg == "--camera-textures")
+            app.camera_textures = true;
+        else if(arg.find("--camera-texture-size=") == 0)
+            app.camera_texture_size = atoi(value().c_str());
+        else if(arg.find("--characters=") == 0)
+            app.character_counts = Bites::parseCpuList(value());
+        else if(arg.find("--character-mesh=") == 0)
+            app.character_mesh = value();
+        else if(arg.find("--character-animation=") == 0)
+            app.character_animation = value();
+        else if(arg == "--parallel-skeletons")
+            app.parallel_skeletons = true;
+        else if(arg == "--sweep-skeletons")
+            app.sweep_skeletons = true;
+        else if(arg == "--software-skinning")
+            app.software_skinning = true;
+        else if(arg == "--sweep-skinning")
+            app.sweep_skinning = true;
+        else if(arg == "--lod")
+            app.lod = true;
+        else if(arg == "--sweep-lod")
+            app.sweep_lod = true;
+        else if(arg.find("--lod-strategy=") == 0)
+            app.lod_strategy = value();
+        else if(arg.find("--lod-levels=") == 0)
+        {
+            if(!Benchmark::MeshLod::parseLevels(value(), app.lod_levels))
+                return false;
+        }
+        else if(arg.find("--lod-segments=") == 0)
+            app.lod_segments = atoi(value().c_str());
+        else if(arg.find("--cluster=") == 0)
+            app.cluster_size = atoi(value().c_str());
+        else if(arg == "--sweep-cluster")
+            app.sweep_cluster = true;
+        else if(arg == "--sweep-instancing")
+            app.sweep_instancing = true;
+        else if(arg == "--soa")
+            app.rotate_cubes = app.soa_animation = true;
+        else if(arg == "--sweep-soa")
+            app.rotate_cubes = app.sweep_soa = true;
+        else if(arg.find("--motion=") == 0)
+        {
+            if(!Benchmark::SoaAnimator::parseMotion(value(), app.motion))
+                return false;
+            app.rotate_cubes = true;
+        }
+        else if(arg == "--sweep-pipeline")
+            app.rotate_cubes = app.sweep_pipeline = true;
+        else if(arg.find("--warmup=") == 0)
+            opts.warmup = atoi(value().c_str());
+        else if(arg.find("--frames=") == 0)
+            opts.frames = atoi(value().c_str());
+        else if(arg.find("--output=") == 0)
+            opts.output = value();
+        else if(arg.find("--compare=") == 0)
+            opts.compare = value();
+        else if(arg.find("--threshold=") == 0)
+            opts.threshold = atof(value().c_str());
+        else if(arg.find("--alpha=") == 0)
+            opts.alpha = atof(value().c_str());
+        else if(arg.find("--record=") == 0)
+            opts.record = value();
+        else if(arg.find("--replay=") == 0)
+            opts.replay = value();
+        else if(arg.find("--fixed-step=") == 0)
+            opts.fixedStep = atof(value().c_str());
+        else if(arg == "--publish")
+            opts.publish = Benchmark::LiveMetrics::DEFAULT_NAME;
+        else if(arg.find("--publish=") == 0)
+            opts.publish = value();
+        else if(arg.find("--trace=") == 0)
+            opts.trace = value();
+        else if(arg.find("--pin-main=") == 0)
+            opts.pinMain = atoi(value().c_str());
+        else if(arg.find("--pin-workers=") == 0)
+            opts.pinWorkers = value();
+        else if(arg.find("--numa-node=") == 0)
+            opts.numaNode = atoi(value().c_str());
+        else if(arg == "--topology")
+            opts.topology = true;
+        else if(arg.find("--preload=") == 0)
+            opts.preload = value();
+        else if(arg == "--preload-sync")
+            opts.preloadSync = true;
+        else if(arg == "--async-log")
+            opts.asyncLog = 4096;
+        else if(arg.find("--async-log=") == 0)
+            opts.asyncLog = atoi(value().c_str());
+        else if(arg == "--arena")
+            app.arena = true;
+        else if(arg == "--arena-thp")
+            app.arena = app.arena_hugepages = true;
+        else if(arg == "--sweep-arena")
+            app.sweep_arena = true;
+        else if(arg.find("--arena-size=") == 0)
+            app.arena_size = size_t(atoi(value().c_str())) << 20;
+        else if(arg == "--tlb")
+            opts.tlb = true;
+        else if(arg == "--sweep-listeners")
+            app.sweep_listeners = true;
+        else if(arg.find("--synthetic-listeners=") == 0)
+            app.synthetic_listeners = atoi(value().c_str());
+        else if(arg == "--quiet-frames")
+            app.quiet_frames = true;
+        else if(arg.find("--workers=") == 0)
+            app.setNumWorkerThreads(atoi(value().c_str()));
+        else if(arg.find("--grid=") == 0)
+            app.grid_size = atoi(value().c_str());
+        else if(arg == "--instancing")
+            app.hw_instancing = true;
+        else if(arg.find("--snapshot-save=") == 0)
+            app.snapshot_save = value();
+        else if(arg.find("--snapshot-load=") == 0)
+            app.snapshot_load = value();
+        else if(arg.find("--dotscene-load=") == 0)
+            app.dotscene_load = value();
+        else if(arg == "--bulk-create")
+            app.bulk_create = true;
+        else if(arg.find("--queries=") == 0)
+            app.queries = atoi(value().c_str());
+        else if(arg.find("--multi-scene=") == 0)
+            app.multi_scenes = atoi(value().c_str());
+        else if(arg.find("--multi-scene-frames=") == 0)
+            app.multi_scene_frames = atoi(value().c_str());
+        else if(arg.find("--autotune=") == 0)
+            app.autotune_budget = atof(value().c_str());
+        else if(arg.find("--autotune-percentile=") == 0)
+            app.autotune_percentile = atof(value().c_str());
+        else if(arg.find("--autotune-max=") == 0)
+            app.autotune_max = atoi(value().c_str());
+        else if(arg.find("--autotune-workers=") == 0)
+            app.autotune_workers = Bites::parseCpuList(value());
+        else if(arg.find("--construction-benchmark=") == 0)
+            app.construction_runs = atoi(value().c_str());
+        else
+            return false;
+    }
+    return true;
+}
+
+static void printUsage(const char* exe)
+{
+    printf("usage: %s [0|1] [--rotate] [--campos=i] [--sweep-campos] [--pipelined] [--sweep-pipeline]\n"
+           "       [--lazy-animation] [--sweep-lazy] [--soa] [--sweep-soa] [--motion=roll|orbit|bob]\n"
+           "       [--warmup=frames] [--frames=frames]\n"
+           "       [--output=results.txt] [--compare=baseline.txt] [--threshold=percent] [--alpha=p]\n"
+           "       [--record=input.bin] [--replay=input.bin] [--fixed-step=seconds] [--workers=n]\n"
+           "       [--trace=trace.json] [--publish[=/shm-name]]\n"
+           "       [--pin-main=cpu] [--pin-workers=cpulist|node] [--numa-node=n] [--topology]\n"
+           "       [--preload=group,...] [--preload-sync]\n"
+           "       [--async-log[=capacity]] [--quiet-frames]\n"
+           "       [--sweep-listeners] [--synthetic-listeners=n]\n"
+           "       [--arena] [--arena-thp] [--sweep-arena] [--arena-size=MiB] [--tlb]\n"
+           "       [--lights=list] [--light-scaling] [--light-range=r] [--light-type=point|spot|mixed]\n"
+           "       [--move-lights] [--sweep-instancing]\n"
+           "       [--cluster=cells] [--sweep-cluster]\n"
+           "       [--lod] [--sweep-lod] [--lod-strategy=distance_sphere|distance_box|pixel_count|screen_ratio_pixel_count]\n"
+           "       [--lod-levels=value:reduction,...] [--lod-segments=n]\n"
+           "       [--cameras=list] [--camera-textures] [--camera-texture-size=px]\n"
+           "       [--characters=list] [--character-mesh=file.mesh] [--character-animation=name]\n"
+           "       [--parallel-skeletons] [--sweep-skeletons] [--software-skinning] [--sweep-skinning]\n"
+           "       [--grid=n] [--instancing] [--snapshot-save=file] [--snapshot-load=file] [--dotscene-load=file.scene]\n"
+           "       [--bulk-create] [--construction-benchmark=repetitions]\n"
+           "       [--multi-scene=k] [--multi-scene-frames=frames] [--queries=n]\n"
+           "       [--autotune=budget_ms] [--autotune-percentile=p] [--autotune-max=grid] [--autotune-workers=list]\n", exe);
+}
+
+/// memory and worker placement, before anything is allocated or started
+static void applyPlacement(MyTestApp& app, const Options& opts, const Bites::CpuTopology& topo)
+{
+    printf("%s", topo.describe().c_str());
+
+    if(opts.numaNode >= 0 && !Bites::setPreferredMemoryNode(opts.numaNode))
+        printf("could not prefer memory of numa node %d\n", opts.numaNode);
+
+    std::vector<int> workers;
+    if(opts.pinWorkers == "node")
+    {
+        // the node memory goes to, otherwise the one of the main thread
+        int node = opts.numaNode >= 0 ? opts.numaNode : topo.nodeOfCpu(opts.pinMain);
+        workers = topo.cpusOfNode(std::max(0, node));
+    }
+    else
+    {
+        workers = Bites::parseCpuList(opts.pinWorkers);
+    }
+
+    // the main thread takes part in every parallel_for, so keep workers off its cpu
+    if(workers.size() > 1)
+        workers.erase(std::remove(workers.begin(), workers.end(), opts.pinMain), workers.end());
+    app.setWorkerCpus(workers);
+    printf("workers: %s\n", workers.empty() ? "not pinned" : ("cpus " + Bites::formatCpuList(workers)).c_str());
+}
+
+/// pinning the main thread after initApp, as threads started by then would inherit its mask
+static void pinMainThread(const Options& opts, const Bites::CpuTopology& topo)
+{
+    if(opts.pinMain >= 0 && !Bites::pinCurrentThread(opts.pinMain))
+        printf("could not pin the main thread to cpu %d\n", opts.pinMain);
+
+    int cpu = Bites::getCurrentCpu();
+    printf("main thread: cpu %d (numa node %d)%s, memory: %s\n", cpu, topo.nodeOfCpu(cpu),
+           opts.pinMain >= 0 ? " pinned" : "",
+           opts.numaNode >= 0 ? ("numa node " + std::to_string(opts.numaNode)).c_str() : "first touch");
+}
+
+static void printJobStats(const std::vector<Bites::JobSystem::WorkerStats>& stats)
+{
+    printf("\n%-8s %10s %10s %12s %8s\n", "worker", "jobs", "steals", "busy (ms)", "util");
+    for(size_t i = 0; i < stats.size(); ++i)
+    {
+        const char* name = i + 1 < stats.size() ? "" : "(ext)";
+        printf("%-3zu%-5s %10zu %10zu %12.2f %7.1f%%\n", i, name, stats[i].jobs, stats[i].steals,
+               stats[i].busyTime, 100 * stats[i].utilisation);
+    }
+}
+//! [options]
 
 //! [main]
 int main(int argc, char *argv[])
 {
     MyTestApp app;
+    app.mainStart = Clock::now();
+    Options opts;
+
+    std::vector<std::string> args(argv + 1, argv + argc);
+    if(!parseArgs(args, app, opts))
+    {
+        printUsage(argv[0]);
+        return 1;
+    }
 
-    app.rotate_cubes = argc > 1 && atoi(argv[1]);
+    // repeat the scenarios of the baseline, explicit arguments take precedence
+    Benchmark::RunResults baseline;
+    if(!opts.compare.empty())
+    {
+        if(!Benchmark::readResults(opts.compare, baseline))
+        {
+            printf("could not read baseline %s\n", opts.compare.c_str());
+            return 1;
+        }
 
+        std::istringstream baseArgs(baseline.args);
+        std::vector<std::string> merged((std::istream_iterator<std::string>(baseArgs)),
+                                        std::istream_iterator<std::string>());
+        merged.insert(merged.end(), args.begin(), args.end());
+        args = merged;
+        parseArgs(args, app, opts);
+    }
+
+    // setMeshLod forces entities, so the instancing scenarios would not instance
+    if(app.sweep_instancing && (app.lod || app.sweep_lod))
+    {
+        printf("--sweep-instancing cannot be combined with --lod or --sweep-lod\n");
+        return 1;
+    }
+
+    if(!opts.compare.empty() && !opts.frames)
+    {
+        printf("comparing needs a fixed number of --frames\n");
+        return 1;
+    }
+
+    // every probe is a scenario, so it needs a fixed length
+    if(app.autotune_budget > 0 && !opts.frames)
+        opts.frames = 300;
+
+    app.runner.setFrames(opts.warmup, opts.frames);
+
+    if(!opts.trace.empty())
+        app.startTracing(opts.trace);
+
+    Bites::CpuTopology topo = Bites::CpuTopology::detect();
+    bool placement = opts.topology || opts.pinMain >= 0 || !opts.pinWorkers.empty() || opts.numaNode >= 0;
+    if(placement)
+        applyPlacement(app, opts, topo);
+
+    if(!opts.preload.empty())
+        app.setResourcePreload(Ogre::StringUtil::split(opts.preload, ","), !opts.preloadSync);
+    if(opts.asyncLog > 0)
+        app.setAsyncLogging(true, opts.asyncLog);
+
+    // before the job system starts its workers, so their misses are counted too
+    if(opts.tlb || app.sweep_arena)
+    {
+        app.tlbMisses.reset(new Benchmark::PerfCounter(Benchmark::PerfCounter::DTLB_READ_MISSES));
+        if(!app.tlbMisses->isOpen())
+        {
+            printf("data TLB misses are not countable here, see kernel.perf_event_paranoid\n");
+            app.tlbMisses.reset();
+        }
+    }
+
+    auto startup = Clock::now();
     app.initApp();
-    app.getRoot()->startRendering();
+#ifdef OGRE_STATIC_LIB
+    printf("initApp: %.2f ms, static plugins\n", msSince(startup));
+#else
+    printf("initApp: %.2f ms, plugins.cfg\n", msSince(startup));
+#endif
+
+    if(placement)
+        pinMainThread(opts, topo);
+
+    if(!opts.record.empty())
+        app.startInputRecording(opts.record);
+    if(!opts.replay.empty() && !app.startInputReplay(opts.replay))
+    {
+        printf("could not read input recording %s\n", opts.replay.c_str());
+        app.closeApp();
+        return 1;
+    }
+
+    if(!opts.publish.empty() && !app.publisher.open(opts.publish))
+        printf("could not create shared memory %s\n", opts.publish.c_str());
+
+    if(app.getResourceLoader())
+    {
+        // whatever the scene setup did not need yet
+        app.finishResourceLoading();
+        printf("preloaded %s\n", app.getResourceLoader()->describe().c_str());
+    }
+
+    app.getJobSystem()->resetStats();
+    app.startRendering(opts.fixedStep);
+    app.setPipelined(false);
+    app.queryBench.reset();
+    app.rqProbe.detach();
+    printJobStats(app.getJobSystem()->getStats());
+    if(app.getAsyncLog())
+        printf("async log: %zu messages, %zu dropped\n", app.getAsyncLog()->getQueued(), app.getAsyncLog()->getDropped());
+    if(app.autotuner)
+        app.autotuner->printTable();
     app.closeApp();
-    return 0;
+    app.publisher.close();
+
+    if(!opts.frames)
+        return 0;
+
+    Benchmark::RunResults& results = app.runner.getResults();
+    results.scenarios.insert(results.scenarios.end(), app.extraResults.begin(), app.extraResults.end());
+    for(const std::string& arg : args)
+    {
+        if(arg.find("--output=") != 0 && arg.find("--compare=") != 0 &&
+           arg.find("--trace=") != 0 && arg.find("--publish") != 0)
+            results.args += (results.args.empty() ? "" : " ") + arg;
+    }
+
+    printf("\n\n");
+    Benchmark::printSummary(results);
+
+    if(!opts.output.empty() && !Benchmark::writeResults(opts.output, results))
+        printf("could not write %s\n", opts.output.c_str());
+
+    if(opts.compare.empty())
+        return 0;
+
+    printf("\n");
+    int regressions = Benchmark::printComparison(
+        Benchmark::compareResults(baseline, results, opts.threshold, opts.alpha));
+    printf("\n%d significant regression(s) against %s\n", regressions, opts.compare.c_str());
+    return regressions ? 2 : 0;
 }
 //! [main]